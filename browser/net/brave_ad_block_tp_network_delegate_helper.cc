@@ -4,22 +4,27 @@
 
 #include "brave/browser/net/brave_ad_block_tp_network_delegate_helper.h"
 
+#include <functional>
+#include <map>
 #include <string>
 
 #include "base/base64url.h"
+#include "base/containers/mru_cache.h"
+#include "base/metrics/histogram_macros_local.h"
+#include "base/no_destructor.h"
 #include "base/strings/string_util.h"
+#include "base/time/time.h"
 #include "brave/browser/brave_browser_process_impl.h"
+#include "brave/browser/net/site_hacks.h"
 #include "brave/common/network_constants.h"
 #include "brave/common/shield_exceptions.h"
-#include "brave/components/brave_shields/browser/ad_block_regional_service.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
+#include "brave/components/brave_shields/browser/dat_file_util.h"
 #include "brave/components/brave_shields/browser/tracking_protection_service.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
-#include "brave/grit/brave_generated_resources.h"
 #include "content/public/browser/browser_thread.h"
-#include "extensions/common/url_pattern.h"
 #include "ui/base/resource/resource_bundle.h"
 
 using content::ResourceType;
@@ -35,34 +40,133 @@ namespace {
         kEmptyImageDataURI : kEmptyDataURI);
   }
 
-}  // namespace
+  const size_t kShieldsDecisionCacheSize = 2000;
 
-namespace brave {
+  // Everything the engines base their decision on.
+  struct ShieldsDecisionKey {
+    explicit ShieldsDecisionKey(const brave::BraveRequestInfo& ctx)
+        : url_spec(ctx.request_url.spec()),
+          tab_host(ctx.tab_origin.host()),
+          resource_type(ctx.resource_type) {
+    }
 
-std::string GetGoogleTagManagerPolyfillJS() {
-  static std::string base64_output;
-  if (base64_output.length() != 0)  {
-    return base64_output;
+    bool operator==(const ShieldsDecisionKey& other) const {
+      return resource_type == other.resource_type &&
+          url_spec == other.url_spec && tab_host == other.tab_host;
+    }
+
+    std::string url_spec;
+    std::string tab_host;
+    ResourceType resource_type;
+  };
+
+  struct ShieldsDecisionKeyHash {
+    size_t operator()(const ShieldsDecisionKey& key) const {
+      std::hash<std::string> hash;
+      size_t result = hash(key.url_spec);
+      result = result * 31 + hash(key.tab_host);
+      return result * 31 + key.resource_type;
+    }
+  };
+
+  // Ad-block and tracking protection results of recently matched requests.
+  // It is only used on the IO thread, so repeated requests are resolved
+  // synchronously, without locking and without the round trip to the
+  // matching task runners. Entries are dropped whenever an engine is
+  // replaced.
+  class ShieldsDecisionCache {
+   public:
+    ShieldsDecisionCache()
+        : decisions_(kShieldsDecisionCacheSize),
+          generation_(brave_shields::GetDATFileEngineGeneration()) {
+    }
+
+    bool Get(const ShieldsDecisionKey& key, brave::BlockedBy* blocked_by) {
+      DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+      const uint32_t generation = brave_shields::GetDATFileEngineGeneration();
+      if (generation != generation_) {
+        decisions_.Clear();
+        generation_ = generation;
+        return false;
+      }
+      auto it = decisions_.Get(key);
+      if (it == decisions_.end()) {
+        return false;
+      }
+      *blocked_by = it->second;
+      return true;
+    }
+
+    // |generation| is the engine generation |blocked_by| was computed with.
+    void Put(const ShieldsDecisionKey& key,
+             uint32_t generation,
+             brave::BlockedBy blocked_by) {
+      DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+      if (generation != generation_ ||
+          generation != brave_shields::GetDATFileEngineGeneration()) {
+        return;
+      }
+      decisions_.Put(key, blocked_by);
+    }
+
+   private:
+    base::HashingMRUCache<ShieldsDecisionKey, brave::BlockedBy,
+                          ShieldsDecisionKeyHash> decisions_;
+    uint32_t generation_;
+
+    DISALLOW_COPY_AND_ASSIGN(ShieldsDecisionCache);
+  };
+
+  ShieldsDecisionCache* GetShieldsDecisionCache() {
+    static base::NoDestructor<ShieldsDecisionCache> cache;
+    return cache.get();
+  }
+
+  // Returns the matching shard of the next request. Consecutive requests,
+  // typically subresources of the same page, go to different shards, so
+  // they are matched in parallel rather than queued behind each other.
+  size_t GetNextMatchingShard() {
+    DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+    static size_t next_shard = 0;
+    const size_t shard = next_shard;
+    next_shard = (next_shard + 1) %
+        brave_shields::BaseBraveShieldsService::GetMatchingShardCount();
+    return shard;
+  }
+
+  void DispatchBlockedEvent(std::shared_ptr<brave::BraveRequestInfo> ctx) {
+    if (ctx->new_url_spec.empty() ||
+        ctx->new_url_spec == ctx->request_url.spec()) {
+      return;
+    }
+    if (ctx->blocked_by == brave::kAdBlocked) {
+      brave_shields::DispatchBlockedEventFromIO(ctx->request_url,
+          ctx->render_frame_id, ctx->render_process_id, ctx->frame_tree_node_id,
+          brave_shields::kAds);
+    } else if (ctx->blocked_by == brave::kTrackerBlocked) {
+      brave_shields::DispatchBlockedEventFromIO(ctx->request_url,
+          ctx->render_frame_id, ctx->render_process_id, ctx->frame_tree_node_id,
+          brave_shields::kTrackers);
+    }
   }
-  std::string str = ui::ResourceBundle::GetSharedInstance().GetRawDataResource(
-    IDR_BRAVE_TAG_MANAGER_POLYFILL).as_string();
-  base64_output.reserve(180);
-  Base64UrlEncode(str, base::Base64UrlEncodePolicy::OMIT_PADDING, &base64_output);
-  base64_output = std::string(kJSDataURLPrefix) + base64_output;
-  return base64_output;
-}
 
-std::string GetGoogleTagServicesPolyfillJS() {
-  static std::string base64_output;
-  if (base64_output.length() != 0)  {
-    return base64_output;
+}  // namespace
+
+namespace brave {
+
+// Returns the script resource |resource_id| as a data URL.
+const std::string& GetPolyfillDataURL(int resource_id) {
+  static base::NoDestructor<std::map<int, std::string>> data_urls;
+  std::string& data_url = (*data_urls)[resource_id];
+  if (data_url.empty()) {
+    std::string base64_output;
+    base::Base64UrlEncode(
+        ui::ResourceBundle::GetSharedInstance().GetRawDataResource(
+            resource_id),
+        base::Base64UrlEncodePolicy::OMIT_PADDING, &base64_output);
+    data_url = std::string(kJSDataURLPrefix) + base64_output;
   }
-  std::string str = ui::ResourceBundle::GetSharedInstance().GetRawDataResource(
-    IDR_BRAVE_TAG_SERVICES_POLYFILL).as_string();
-  base64_output.reserve(4668);
-  Base64UrlEncode(str, base::Base64UrlEncodePolicy::OMIT_PADDING, &base64_output);
-  base64_output = std::string(kJSDataURLPrefix) + base64_output;
-  return base64_output;
+  return data_url;
 }
 
 bool GetPolyfillForAdBlock(bool allow_brave_shields, bool allow_ads,
@@ -72,24 +176,16 @@ bool GetPolyfillForAdBlock(bool allow_brave_shields, bool allow_ads,
     return false;
   }
 
-  static URLPattern tag_manager(URLPattern::SCHEME_ALL, kGoogleTagManagerPattern);
-  static URLPattern tag_services(URLPattern::SCHEME_ALL, kGoogleTagServicesPattern);
-  if (tag_manager.MatchesURL(gurl)) {
-    std::string&& data_url = GetGoogleTagManagerPolyfillJS();
-    *new_url_spec = data_url;
-    return true;
-  }
-
-  if (tag_services.MatchesURL(gurl)) {
-    std::string&& data_url = GetGoogleTagServicesPolyfillJS();
-    *new_url_spec = data_url;
-    return true;
+  const int resource_id = SiteHacks::GetInstance()->GetAdBlockPolyfill(gurl);
+  if (!resource_id) {
+    return false;
   }
-
-  return false;
+  *new_url_spec = GetPolyfillDataURL(resource_id);
+  return true;
 }
 
-void OnBeforeURLRequestAdBlockTPOnTaskRunner(std::shared_ptr<BraveRequestInfo> ctx) {
+void OnBeforeURLRequestAdBlockTPOnTaskRunner(
+    std::shared_ptr<BraveRequestInfo> ctx, size_t shard) {
   // If the following info isn't available, then proper content settings can't
   // be looked up, so do nothing.
   if (ctx->tab_origin.is_empty() || !ctx->tab_origin.has_host() ||
@@ -100,14 +196,14 @@ void OnBeforeURLRequestAdBlockTPOnTaskRunner(std::shared_ptr<BraveRequestInfo> c
 
   std::string tab_host = ctx->tab_origin.host();
   if (!g_brave_browser_process->tracking_protection_service()->
-      ShouldStartRequest(ctx->request_url, ctx->resource_type, tab_host)) {
+      ShouldStartRequest(ctx->request_url, ctx->resource_type, tab_host,
+                         shard)) {
     ctx->new_url_spec = GetBlankDataURLForResourceType(ctx->resource_type).spec();
     ctx->blocked_by = kTrackerBlocked;
   } else if (!g_brave_browser_process->ad_block_service()->ShouldStartRequest(
-           ctx->request_url, ctx->resource_type, tab_host) ||
-       !g_brave_browser_process->ad_block_regional_service()
-            ->ShouldStartRequest(ctx->request_url, ctx->resource_type,
-                                 tab_host)) {
+           ctx->request_url, ctx->resource_type, tab_host, shard)) {
+    // Also covers the regional lists, which the ad block service matches
+    // in the same pass as the default list.
     ctx->new_url_spec = GetBlankDataURLForResourceType(ctx->resource_type).spec();
     ctx->blocked_by = kAdBlocked;
   }
@@ -115,20 +211,17 @@ void OnBeforeURLRequestAdBlockTPOnTaskRunner(std::shared_ptr<BraveRequestInfo> c
 
 void OnBeforeURLRequestDispatchOnIOThread(
     const ResponseCallback& next_callback,
-    std::shared_ptr<BraveRequestInfo> ctx) {
+    std::shared_ptr<BraveRequestInfo> ctx,
+    const ShieldsDecisionKey& decision_key,
+    uint32_t engine_generation,
+    base::TimeTicks start_time) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
-  if (!ctx->new_url_spec.empty() &&
-    ctx->new_url_spec != ctx->request_url.spec()) {
-    if (ctx->blocked_by == kAdBlocked) {
-      brave_shields::DispatchBlockedEventFromIO(ctx->request_url,
-          ctx->render_frame_id, ctx->render_process_id, ctx->frame_tree_node_id,
-          brave_shields::kAds);
-    } else if (ctx->blocked_by == kTrackerBlocked) {
-      brave_shields::DispatchBlockedEventFromIO(ctx->request_url,
-          ctx->render_frame_id, ctx->render_process_id, ctx->frame_tree_node_id,
-          brave_shields::kTrackers);
-    }
-  }
+  GetShieldsDecisionCache()->Put(decision_key, engine_generation,
+                                 ctx->blocked_by);
+  DispatchBlockedEvent(ctx);
+  LOCAL_HISTOGRAM_CUSTOM_COUNTS(
+      "Brave.Shields.AdBlockTP.AsyncDecisionMicroseconds",
+      (base::TimeTicks::Now() - start_time).InMicroseconds(), 1, 1000000, 50);
 
   next_callback.Run();
 }
@@ -159,11 +252,31 @@ int OnBeforeURLRequest_AdBlockTPPreWork(
     return net::OK;
   }
 
+  const base::TimeTicks start_time = base::TimeTicks::Now();
+  const ShieldsDecisionKey decision_key(*ctx);
+  BlockedBy blocked_by = kNotBlocked;
+  if (GetShieldsDecisionCache()->Get(decision_key, &blocked_by)) {
+    if (blocked_by != kNotBlocked) {
+      ctx->new_url_spec =
+          GetBlankDataURLForResourceType(ctx->resource_type).spec();
+      ctx->blocked_by = blocked_by;
+      DispatchBlockedEvent(ctx);
+    }
+    LOCAL_HISTOGRAM_CUSTOM_COUNTS(
+        "Brave.Shields.AdBlockTP.SyncDecisionMicroseconds",
+        (base::TimeTicks::Now() - start_time).InMicroseconds(), 1, 1000000,
+        50);
+    return net::OK;
+  }
+
+  const size_t shard = GetNextMatchingShard();
   g_brave_browser_process->ad_block_service()->
-        GetTaskRunner()->PostTaskAndReply(FROM_HERE,
-          base::Bind(&OnBeforeURLRequestAdBlockTPOnTaskRunner, ctx),
+        GetMatchingTaskRunner(shard)->PostTaskAndReply(FROM_HERE,
+          base::Bind(&OnBeforeURLRequestAdBlockTPOnTaskRunner, ctx, shard),
           base::Bind(base::IgnoreResult(
-              &OnBeforeURLRequestDispatchOnIOThread), next_callback, ctx));
+              &OnBeforeURLRequestDispatchOnIOThread), next_callback, ctx,
+              decision_key, brave_shields::GetDATFileEngineGeneration(),
+              start_time));
 
   return net::ERR_IO_PENDING;
 }
@@ -25,6 +25,8 @@ using content::BrowserThread;
 using net::URLRequest;
 
 
+#define MAX_FREE_REQUEST_CONTEXTS 64
+
 namespace {
 
   content::WebContents* GetWebContentsFromProcessAndFrameId(
@@ -92,9 +94,7 @@ int BraveNetworkDelegateBase::OnBeforeURLRequest(URLRequest* request,
   if (before_url_request_callbacks_.empty() || !request) {
     return ChromeNetworkDelegate::OnBeforeURLRequest(request, std::move(callback), new_url);
   }
-  std::shared_ptr<brave::BraveRequestInfo> ctx(
-      new brave::BraveRequestInfo());
-  brave::BraveRequestInfo::FillCTXFromRequest(request, ctx);
+  std::shared_ptr<brave::BraveRequestInfo> ctx = GetRequestContext(request);
   ctx->new_url = new_url;
   ctx->event_type = brave::kOnBeforeRequest;
   callbacks_[request->identifier()] = std::move(callback);
@@ -109,9 +109,7 @@ int BraveNetworkDelegateBase::OnBeforeStartTransaction(URLRequest* request,
     return ChromeNetworkDelegate::OnBeforeStartTransaction(request, std::move(callback),
                                                            headers);
   }
-  std::shared_ptr<brave::BraveRequestInfo> ctx(
-      new brave::BraveRequestInfo());
-  brave::BraveRequestInfo::FillCTXFromRequest(request, ctx);
+  std::shared_ptr<brave::BraveRequestInfo> ctx = GetRequestContext(request);
   ctx->event_type = brave::kOnBeforeStartTransaction;
   ctx->headers = headers;
   ctx->referral_headers_list = referral_headers_list_.get();
@@ -131,10 +129,8 @@ int BraveNetworkDelegateBase::OnHeadersReceived(URLRequest* request,
         override_response_headers, allowed_unsafe_redirect_url);
   }
 
-  std::shared_ptr<brave::BraveRequestInfo> ctx(
-      new brave::BraveRequestInfo());
+  std::shared_ptr<brave::BraveRequestInfo> ctx = GetRequestContext(request);
   callbacks_[request->identifier()] = std::move(callback);
-  brave::BraveRequestInfo::FillCTXFromRequest(request, ctx);
   ctx->event_type = brave::kOnHeadersReceived;
   ctx->original_response_headers = original_response_headers;
   ctx->override_response_headers = override_response_headers;
@@ -154,9 +150,7 @@ int BraveNetworkDelegateBase::OnHeadersReceived(URLRequest* request,
 bool BraveNetworkDelegateBase::OnCanGetCookies(const URLRequest& request,
     const net::CookieList& cookie_list,
     bool allowed_from_caller) {
-  std::shared_ptr<brave::BraveRequestInfo> ctx(
-      new brave::BraveRequestInfo());
-  brave::BraveRequestInfo::FillCTXFromRequest(&request, ctx);
+  std::shared_ptr<brave::BraveRequestInfo> ctx = GetRequestContext(&request);
   ctx->event_type = brave::kOnCanGetCookies;
   bool allow = std::all_of(can_get_cookies_callbacks_.begin(), can_get_cookies_callbacks_.end(),
       [&ctx](brave::OnCanGetCookiesCallback callback){
@@ -180,9 +174,7 @@ bool BraveNetworkDelegateBase::OnCanSetCookie(const URLRequest& request,
     const net::CanonicalCookie& cookie,
     net::CookieOptions* options,
     bool allowed_from_caller) {
-  std::shared_ptr<brave::BraveRequestInfo> ctx(
-      new brave::BraveRequestInfo());
-  brave::BraveRequestInfo::FillCTXFromRequest(&request, ctx);
+  std::shared_ptr<brave::BraveRequestInfo> ctx = GetRequestContext(&request);
   ctx->event_type = brave::kOnCanSetCookies;
 
   bool allow = std::all_of(can_set_cookies_callbacks_.begin(), can_set_cookies_callbacks_.end(),
@@ -311,9 +303,48 @@ void BraveNetworkDelegateBase::OnURLRequestDestroyed(URLRequest* request) {
   if (ContainsKey(callbacks_, request->identifier())) {
     callbacks_.erase(request->identifier());
   }
+  ReleaseRequestContext(request);
   ChromeNetworkDelegate::OnURLRequestDestroyed(request);
 }
 
+std::shared_ptr<brave::BraveRequestInfo>
+BraveNetworkDelegateBase::GetRequestContext(const URLRequest* request) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  std::shared_ptr<brave::BraveRequestInfo>& ctx =
+      request_contexts_[request->identifier()];
+  if (!ctx) {
+    if (!free_request_contexts_.empty()) {
+      ctx = std::move(free_request_contexts_.back());
+      free_request_contexts_.pop_back();
+    } else {
+      ctx = std::make_shared<brave::BraveRequestInfo>();
+    }
+    brave::BraveRequestInfo::FillCTXFromRequest(request, ctx);
+  } else if (!brave::BraveRequestInfo::IsCTXUpToDate(request, *ctx)) {
+    ctx->Reset();
+    brave::BraveRequestInfo::FillCTXFromRequest(request, ctx);
+  }
+  ctx->ResetEventState();
+  return ctx;
+}
+
+void BraveNetworkDelegateBase::ReleaseRequestContext(
+    const URLRequest* request) {
+  auto it = request_contexts_.find(request->identifier());
+  if (it == request_contexts_.end()) {
+    return;
+  }
+  std::shared_ptr<brave::BraveRequestInfo> ctx = std::move(it->second);
+  request_contexts_.erase(it);
+  // A helper may still hold the context in a pending task, in which case it
+  // is left to be deleted with the task.
+  if (ctx.use_count() == 1 &&
+      free_request_contexts_.size() < MAX_FREE_REQUEST_CONTEXTS) {
+    ctx->Reset();
+    free_request_contexts_.push_back(std::move(ctx));
+  }
+}
+
 bool BraveNetworkDelegateBase::IsRequestIdentifierValid(uint64_t request_identifier) {
   return ContainsKey(callbacks_, request_identifier);
 }
@@ -5,6 +5,10 @@
 #ifndef BRAVE_BROWSER_NET_BRAVE_NETWORK_DELEGATE_BASE_H_
 #define BRAVE_BROWSER_NET_BRAVE_NETWORK_DELEGATE_BASE_H_
 
+#include <map>
+#include <memory>
+#include <vector>
+
 #include "brave/browser/net/url_context.h"
 #include "chrome/browser/net/chrome_network_delegate.h"
 #include "content/public/browser/browser_thread.h"
@@ -76,11 +80,23 @@ class BraveNetworkDelegateBase : public ChromeNetworkDelegate {
       can_set_cookies_callbacks_;
 
  private:
+  // Returns the context of |request|, which is created on the first network
+  // delegate event of the request and reused by the following ones. It is
+  // only filled again when the URL or first party of the request changed,
+  // e.g. after a redirect.
+  std::shared_ptr<brave::BraveRequestInfo> GetRequestContext(
+      const net::URLRequest* request);
+  void ReleaseRequestContext(const net::URLRequest* request);
+
   void InitPrefChangeRegistrar();
   void GetReferralHeaders();
   void OnReferralHeadersChanged();
   std::unique_ptr<base::ListValue> referral_headers_list_;
   std::map<uint64_t, net::CompletionOnceCallback> callbacks_;
+  std::map<uint64_t, std::shared_ptr<brave::BraveRequestInfo>>
+      request_contexts_;
+  // Contexts of destroyed requests, kept for reuse.
+  std::vector<std::shared_ptr<brave::BraveRequestInfo>> free_request_contexts_;
   std::unique_ptr<PrefChangeRegistrar, content::BrowserThread::DeleteOnUIThread>
       pref_change_registrar_;
 
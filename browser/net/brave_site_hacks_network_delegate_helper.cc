@@ -7,9 +7,7 @@
 #include <string>
 
 #include "base/sequenced_task_runner.h"
-#include "base/strings/string_util.h"
-#include "brave/common/network_constants.h"
-#include "brave/common/shield_exceptions.h"
+#include "brave/browser/net/site_hacks.h"
 #include "brave/common/url_constants.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
@@ -17,7 +15,6 @@
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/resource_request_info.h"
 #include "content/public/common/referrer.h"
-#include "extensions/common/url_pattern.h"
 #include "net/url_request/url_request.h"
 
 using content::BrowserThread;
@@ -32,15 +29,13 @@ bool ApplyPotentialReferrerBlock(net::URLRequest* request) {
   if (tab_origin.SchemeIs(kChromeExtensionScheme)) {
     return false;
   }
-  bool allow_referrers = brave_shields::IsAllowContentSettingFromIO(
-      request, tab_origin, tab_origin, CONTENT_SETTINGS_TYPE_PLUGINS,
-      brave_shields::kReferrers);
-  bool shields_up = brave_shields::IsAllowContentSettingFromIO(
-      request, tab_origin, GURL(), CONTENT_SETTINGS_TYPE_PLUGINS,
-      brave_shields::kBraveShields);
+  // Usually already cached for this origin by FillCTXFromRequest.
+  const brave_shields::ShieldsSettings settings =
+      brave_shields::GetShieldsSettingsFromIO(request, tab_origin);
   const std::string original_referrer = request->referrer();
   Referrer new_referrer;
-  if (brave_shields::ShouldSetReferrer(allow_referrers, shields_up,
+  if (brave_shields::ShouldSetReferrer(settings.allow_referrers,
+          settings.allow_brave_shields,
           GURL(original_referrer), tab_origin, request->url(), target_origin,
           Referrer::NetReferrerPolicyToBlinkReferrerPolicy(
               request->referrer_policy()), &new_referrer)) {
@@ -66,49 +61,14 @@ int OnBeforeURLRequest_SiteHacksWork(
   return net::OK;
 }
 
-void CheckForCookieOverride(const GURL& url, const URLPattern& pattern,
-    net::HttpRequestHeaders* headers, const std::string& extra_cookies) {
-  if (pattern.MatchesURL(url)) {
-    std::string cookies;
-    if (headers->GetHeader(kCookieHeader, &cookies)) {
-      cookies = "; ";
-    }
-    cookies += extra_cookies;
-    headers->SetHeader(kCookieHeader, cookies);
-  }
-}
-
-bool IsBlockTwitterSiteHack(net::URLRequest* request,
-    net::HttpRequestHeaders* headers) {
-  URLPattern redirectURLPattern(URLPattern::SCHEME_ALL, kTwitterRedirectURL);
-  URLPattern referrerPattern(URLPattern::SCHEME_ALL, kTwitterReferrer);
-  if (redirectURLPattern.MatchesURL(request->url())) {
-    std::string referrer;
-    if (headers->GetHeader(kRefererHeader, &referrer) &&
-        referrerPattern.MatchesURL(GURL(referrer))) {
-      return true;
-    }
-  }
-  return false;
-}
-
 int OnBeforeStartTransaction_SiteHacksWork(net::URLRequest* request,
         net::HttpRequestHeaders* headers,
         const ResponseCallback& next_callback,
         std::shared_ptr<BraveRequestInfo> ctx) {
-  CheckForCookieOverride(request->url(),
-      URLPattern(URLPattern::SCHEME_ALL, kForbesPattern), headers,
-      kForbesExtraCookies);
-  if (IsBlockTwitterSiteHack(request, headers)) {
+  if (!SiteHacks::GetInstance()->ApplyRequestHeaderHacks(request->url(),
+                                                         headers)) {
     return net::ERR_ABORTED;
   }
-  if (IsUAWhitelisted(request->url())) {
-    std::string user_agent;
-    if (headers->GetHeader(kUserAgentHeader, &user_agent)) {
-      base::ReplaceFirstSubstringAfterOffset(&user_agent, 0, "Chrome", "Brave Chrome");
-      headers->SetHeader(kUserAgentHeader, user_agent);
-    }
-  }
   return net::OK;
 }
 
@@ -0,0 +1,113 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/site_hacks.h"
+
+#include <string>
+
+#include "base/no_destructor.h"
+#include "base/strings/string_util.h"
+#include "brave/common/network_constants.h"
+#include "brave/grit/brave_generated_resources.h"
+#include "extensions/common/url_pattern.h"
+#include "net/http/http_request_headers.h"
+#include "url/gurl.h"
+
+namespace brave {
+
+namespace {
+
+std::vector<SiteHack> GetSiteHacksTable() {
+  return std::vector<SiteHack>({
+    { SiteHack::ADD_COOKIES, kForbesPattern, kForbesExtraCookies, 0 },
+    // Twitter redirects to its no script page if a script is blocked.
+    { SiteHack::ABORT_FROM_REFERRER, kTwitterRedirectURL, kTwitterReferrer,
+      0 },
+    { SiteHack::BRAVE_USER_AGENT, "https://*.adobe.com/*", nullptr, 0 },
+    { SiteHack::BRAVE_USER_AGENT, "https://*.duckduckgo.com/*", nullptr, 0 },
+    { SiteHack::BRAVE_USER_AGENT, "https://*.brave.com/*", nullptr, 0 },
+    // For Widevine
+    { SiteHack::BRAVE_USER_AGENT, "https://*.netflix.com/*", nullptr, 0 },
+    { SiteHack::AD_BLOCK_POLYFILL, kGoogleTagManagerPattern, nullptr,
+      IDR_BRAVE_TAG_MANAGER_POLYFILL },
+    { SiteHack::AD_BLOCK_POLYFILL, kGoogleTagServicesPattern, nullptr,
+      IDR_BRAVE_TAG_SERVICES_POLYFILL },
+  });
+}
+
+}  // namespace
+
+SiteHacks::SiteHacks(const std::vector<SiteHack>& hacks)
+    : hacks_(hacks), referrer_patterns_(hacks.size()) {
+  for (size_t i = 0; i < hacks_.size(); ++i) {
+    url_patterns_.Add(
+        URLPattern(URLPattern::SCHEME_ALL, hacks_[i].url_pattern), i);
+    if (hacks_[i].action == SiteHack::ABORT_FROM_REFERRER) {
+      referrer_patterns_[i].reset(
+          new URLPattern(URLPattern::SCHEME_ALL, hacks_[i].value));
+    }
+  }
+}
+
+SiteHacks::~SiteHacks() {
+}
+
+// static
+const SiteHacks* SiteHacks::GetInstance() {
+  static base::NoDestructor<SiteHacks> site_hacks(GetSiteHacksTable());
+  return site_hacks.get();
+}
+
+bool SiteHacks::ApplyRequestHeaderHacks(const GURL& url,
+    net::HttpRequestHeaders* headers) const {
+  std::vector<size_t> matches;
+  url_patterns_.GetMatchingIDs(url, &matches);
+  for (size_t i : matches) {
+    const SiteHack& hack = hacks_[i];
+    switch (hack.action) {
+      case SiteHack::ADD_COOKIES: {
+        std::string cookies;
+        if (headers->GetHeader(kCookieHeader, &cookies)) {
+          cookies = "; ";
+        }
+        cookies += hack.value;
+        headers->SetHeader(kCookieHeader, cookies);
+        break;
+      }
+      case SiteHack::BRAVE_USER_AGENT: {
+        std::string user_agent;
+        if (headers->GetHeader(kUserAgentHeader, &user_agent)) {
+          base::ReplaceFirstSubstringAfterOffset(&user_agent, 0, "Chrome",
+                                                 "Brave Chrome");
+          headers->SetHeader(kUserAgentHeader, user_agent);
+        }
+        break;
+      }
+      case SiteHack::ABORT_FROM_REFERRER: {
+        std::string referrer;
+        if (headers->GetHeader(kRefererHeader, &referrer) &&
+            referrer_patterns_[i]->MatchesURL(GURL(referrer))) {
+          return false;
+        }
+        break;
+      }
+      case SiteHack::AD_BLOCK_POLYFILL:
+        break;
+    }
+  }
+  return true;
+}
+
+int SiteHacks::GetAdBlockPolyfill(const GURL& url) const {
+  std::vector<size_t> matches;
+  url_patterns_.GetMatchingIDs(url, &matches);
+  for (size_t i : matches) {
+    if (hacks_[i].action == SiteHack::AD_BLOCK_POLYFILL) {
+      return hacks_[i].resource_id;
+    }
+  }
+  return 0;
+}
+
+}  // namespace brave
@@ -0,0 +1,75 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_BROWSER_NET_SITE_HACKS_H_
+#define BRAVE_BROWSER_NET_SITE_HACKS_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "brave/common/host_indexed_url_patterns.h"
+
+class GURL;
+class URLPattern;
+
+namespace net {
+class HttpRequestHeaders;
+}
+
+namespace brave {
+
+// A request fix for a specific site. The ones in use are listed by
+// GetSiteHacksTable() in site_hacks.cc.
+struct SiteHack {
+  enum Action {
+    // Appends |value| to the Cookie header.
+    ADD_COOKIES,
+    // Inserts "Brave" before "Chrome" in the User-Agent header.
+    BRAVE_USER_AGENT,
+    // Aborts the request if its Referer header matches the URL pattern
+    // |value|.
+    ABORT_FROM_REFERRER,
+    // Redirects the request to the script resource |resource_id| while ads
+    // are blocked.
+    AD_BLOCK_POLYFILL,
+  };
+
+  Action action;
+  // The requests the hack applies to.
+  const char* url_pattern;
+  const char* value;
+  int resource_id;
+};
+
+// Site hacks indexed by the host of their URL pattern, so that a request to
+// a host without hacks costs one hash probe per host label.
+class SiteHacks {
+ public:
+  explicit SiteHacks(const std::vector<SiteHack>& hacks);
+  ~SiteHacks();
+
+  // Returns the hacks of GetSiteHacksTable().
+  static const SiteHacks* GetInstance();
+
+  // Applies the header hacks for |url| to |headers|. Returns false if the
+  // request should be aborted.
+  bool ApplyRequestHeaderHacks(const GURL& url,
+                               net::HttpRequestHeaders* headers) const;
+  // Returns the polyfill resource to redirect |url| to while ads are
+  // blocked, or 0.
+  int GetAdBlockPolyfill(const GURL& url) const;
+
+ private:
+  std::vector<SiteHack> hacks_;
+  // |value| of ABORT_FROM_REFERRER hacks, by hack index.
+  std::vector<std::unique_ptr<URLPattern>> referrer_patterns_;
+  HostIndexedURLPatterns url_patterns_;
+
+  DISALLOW_COPY_AND_ASSIGN(SiteHacks);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_BROWSER_NET_SITE_HACKS_H_
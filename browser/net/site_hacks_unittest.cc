@@ -0,0 +1,115 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/browser/net/site_hacks.h"
+
+#include <string>
+#include <vector>
+
+#include "brave/common/network_constants.h"
+#include "brave/grit/brave_generated_resources.h"
+#include "net/http/http_request_headers.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+using brave::SiteHack;
+using brave::SiteHacks;
+
+namespace {
+
+const char kChromeUserAgent[] =
+    "Mozilla/5.0 (Windows NT 6.3; WOW64) AppleWebKit/537.36 "
+    "(KHTML, like Gecko) Chrome/33.0.1750.117 Safari/537.36";
+
+bool IsBraveUserAgent(const GURL& url) {
+  net::HttpRequestHeaders headers;
+  headers.SetHeader(kUserAgentHeader, kChromeUserAgent);
+  EXPECT_TRUE(SiteHacks::GetInstance()->ApplyRequestHeaderHacks(url,
+                                                                &headers));
+  std::string user_agent;
+  headers.GetHeader(kUserAgentHeader, &user_agent);
+  return user_agent != kChromeUserAgent;
+}
+
+}  // namespace
+
+TEST(SiteHacksTest, UserAgentOnlyForListedDomains) {
+  EXPECT_TRUE(IsBraveUserAgent(GURL("https://adobe.com/")));
+  EXPECT_TRUE(IsBraveUserAgent(GURL("https://www.adobe.com/")));
+  EXPECT_TRUE(IsBraveUserAgent(GURL("https://a.b.duckduckgo.com/q")));
+  EXPECT_TRUE(IsBraveUserAgent(GURL("https://brave.com./")));
+  EXPECT_FALSE(IsBraveUserAgent(GURL("https://notadobe.com/")));
+  EXPECT_FALSE(IsBraveUserAgent(GURL("https://adobe.com.test.com/")));
+  EXPECT_FALSE(IsBraveUserAgent(GURL("http://www.adobe.com/")));
+}
+
+TEST(SiteHacksTest, AdBlockPolyfill) {
+  const SiteHacks* site_hacks = SiteHacks::GetInstance();
+  EXPECT_EQ(IDR_BRAVE_TAG_MANAGER_POLYFILL,
+            site_hacks->GetAdBlockPolyfill(GURL(kGoogleTagManagerPattern)));
+  EXPECT_EQ(IDR_BRAVE_TAG_SERVICES_POLYFILL,
+            site_hacks->GetAdBlockPolyfill(GURL(kGoogleTagServicesPattern)));
+  EXPECT_EQ(0, site_hacks->GetAdBlockPolyfill(
+      GURL("https://www.googletagmanager.com/other.js")));
+  // Header hacks are not polyfills.
+  EXPECT_EQ(0, site_hacks->GetAdBlockPolyfill(GURL("https://www.forbes.com/")));
+}
+
+TEST(SiteHacksTest, HacksForTheSameHostApplyInTableOrder) {
+  SiteHacks site_hacks(std::vector<SiteHack>({
+    { SiteHack::ADD_COOKIES, "https://*.example.com/*", "a=1", 0 },
+    { SiteHack::ABORT_FROM_REFERRER, "https://www.example.com/abort*",
+      "https://example.com/*", 0 },
+    { SiteHack::BRAVE_USER_AGENT, "https://www.example.com/*", nullptr, 0 },
+  }));
+
+  net::HttpRequestHeaders headers;
+  headers.SetHeader(kUserAgentHeader, "Chrome");
+  EXPECT_TRUE(site_hacks.ApplyRequestHeaderHacks(
+      GURL("https://www.example.com/"), &headers));
+  std::string value;
+  EXPECT_TRUE(headers.GetHeader(kCookieHeader, &value));
+  EXPECT_EQ("a=1", value);
+  EXPECT_TRUE(headers.GetHeader(kUserAgentHeader, &value));
+  EXPECT_EQ("Brave Chrome", value);
+
+  headers.Clear();
+  headers.SetHeader(kRefererHeader, "https://example.com/");
+  EXPECT_FALSE(site_hacks.ApplyRequestHeaderHacks(
+      GURL("https://www.example.com/abort"), &headers));
+  headers.SetHeader(kRefererHeader, "https://other.com/");
+  EXPECT_TRUE(site_hacks.ApplyRequestHeaderHacks(
+      GURL("https://www.example.com/abort"), &headers));
+}
+
+TEST(SiteHacksTest, HeaderHacksOnlyForMatchingRequests) {
+  const SiteHacks* site_hacks = SiteHacks::GetInstance();
+
+  // hosts without hacks, including ones sharing a suffix with a hack's host
+  net::HttpRequestHeaders headers;
+  for (const char* url : {"https://cdn.static.example.com/script.js",
+                          "https://forbes.com/",
+                          "https://www.forbes.com.example.com/",
+                          "https://twitter.com/i/nojs_router"}) {
+    EXPECT_TRUE(site_hacks->ApplyRequestHeaderHacks(GURL(url), &headers))
+        << url;
+    EXPECT_TRUE(headers.IsEmpty()) << url;
+    EXPECT_EQ(0, site_hacks->GetAdBlockPolyfill(GURL(url))) << url;
+  }
+
+  EXPECT_TRUE(site_hacks->ApplyRequestHeaderHacks(
+      GURL("https://www.forbes.com/"), &headers));
+  std::string cookies;
+  EXPECT_TRUE(headers.GetHeader(kCookieHeader, &cookies));
+  EXPECT_EQ(kForbesExtraCookies, cookies);
+
+  const GURL twitter_redirect("https://mobile.twitter.com/i/nojs_router");
+  headers.Clear();
+  headers.SetHeader(kRefererHeader, "https://twitter.com/brave");
+  EXPECT_FALSE(site_hacks->ApplyRequestHeaderHacks(twitter_redirect,
+                                                   &headers));
+  headers.SetHeader(kRefererHeader, "https://example.com/");
+  EXPECT_TRUE(site_hacks->ApplyRequestHeaderHacks(twitter_redirect,
+                                                  &headers));
+}
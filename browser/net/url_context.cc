@@ -10,7 +10,6 @@
 #include "brave/common/url_constants.h"
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
-#include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "content/public/browser/resource_request_info.h"
 
 namespace brave {
@@ -25,6 +24,7 @@ void BraveRequestInfo::FillCTXFromRequest(const net::URLRequest* request,
     std::shared_ptr<brave::BraveRequestInfo> ctx) {
   ctx->request_identifier = request->identifier();
   ctx->request_url = request->url();
+  ctx->site_for_cookies = request->site_for_cookies();
   auto* request_info = content::ResourceRequestInfo::ForRequest(request);
   if (request_info) {
     ctx->resource_type = request_info->GetResourceType();
@@ -44,23 +44,58 @@ void BraveRequestInfo::FillCTXFromRequest(const net::URLRequest* request,
                                      ctx->frame_tree_node_id).GetOrigin();
   }
   ctx->tab_origin = ctx->tab_url.GetOrigin();
-  ctx->allow_brave_shields = brave_shields::IsAllowContentSettingFromIO(
-      request, ctx->tab_origin, ctx->tab_origin, CONTENT_SETTINGS_TYPE_PLUGINS,
-      brave_shields::kBraveShields) &&
+  const brave_shields::ShieldsSettings settings =
+      brave_shields::GetShieldsSettingsFromIO(request, ctx->tab_origin);
+  ctx->allow_brave_shields = settings.allow_brave_shields &&
     !request->site_for_cookies().SchemeIs(kChromeExtensionScheme);
-  ctx->allow_ads = brave_shields::IsAllowContentSettingFromIO(
-      request, ctx->tab_origin, ctx->tab_origin, CONTENT_SETTINGS_TYPE_PLUGINS,
-      brave_shields::kAds);
-  ctx->allow_http_upgradable_resource = brave_shields::IsAllowContentSettingFromIO(
-      request, ctx->tab_origin, ctx->tab_origin, CONTENT_SETTINGS_TYPE_PLUGINS,
-      brave_shields::kHTTPUpgradableResources);
-  ctx->allow_1p_cookies = brave_shields::IsAllowContentSettingFromIO(
-      request, ctx->tab_origin, GURL("https://firstParty/"), CONTENT_SETTINGS_TYPE_PLUGINS,
-      brave_shields::kCookies);
-  ctx->allow_3p_cookies = brave_shields::IsAllowContentSettingFromIO(
-      request, ctx->tab_origin, GURL(), CONTENT_SETTINGS_TYPE_PLUGINS,
-      brave_shields::kCookies);
+  ctx->allow_ads = settings.allow_ads;
+  ctx->allow_http_upgradable_resource =
+      settings.allow_http_upgradable_resources;
+  ctx->allow_1p_cookies = settings.allow_1p_cookies;
+  ctx->allow_3p_cookies = settings.allow_3p_cookies;
   ctx->request = request;
 }
 
+// static
+bool BraveRequestInfo::IsCTXUpToDate(const net::URLRequest* request,
+    const brave::BraveRequestInfo& ctx) {
+  return ctx.request == request &&
+      ctx.request_identifier == request->identifier() &&
+      ctx.request_url == request->url() &&
+      ctx.site_for_cookies == request->site_for_cookies();
+}
+
+void BraveRequestInfo::ResetEventState() {
+  new_url_spec.clear();
+  referrer_changed = false;
+  next_url_request_index = 0;
+  headers = nullptr;
+  original_response_headers = nullptr;
+  override_response_headers = nullptr;
+  allowed_unsafe_redirect_url = nullptr;
+  event_type = kUnknownEventType;
+  referral_headers_list = nullptr;
+  new_url = nullptr;
+}
+
+void BraveRequestInfo::Reset() {
+  ResetEventState();
+  request_url = GURL();
+  tab_origin = GURL();
+  tab_url = GURL();
+  site_for_cookies = GURL();
+  allow_brave_shields = true;
+  allow_ads = false;
+  allow_http_upgradable_resource = false;
+  allow_1p_cookies = true;
+  allow_3p_cookies = false;
+  render_process_id = 0;
+  render_frame_id = 0;
+  frame_tree_node_id = 0;
+  request_identifier = 0;
+  blocked_by = kNotBlocked;
+  resource_type = content::RESOURCE_TYPE_LAST_TYPE;
+  request = nullptr;
+}
+
 }  // namespace brave
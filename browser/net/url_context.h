@@ -52,6 +52,7 @@ struct BraveRequestInfo {
   GURL request_url;
   GURL tab_origin;
   GURL tab_url;
+  GURL site_for_cookies;
   std::string new_url_spec;
   bool allow_brave_shields = true;
   bool allow_ads = false;
@@ -78,6 +79,18 @@ struct BraveRequestInfo {
   static void FillCTXFromRequest(const net::URLRequest* request,
     std::shared_ptr<brave::BraveRequestInfo> ctx);
 
+  // Returns true if |ctx| was filled from |request| while the request had
+  // its current URL and first party, so it can be reused for a new event.
+  static bool IsCTXUpToDate(const net::URLRequest* request,
+    const brave::BraveRequestInfo& ctx);
+
+  // Restores the defaults of the fields which only apply to a single network
+  // delegate event, keeping what is known about the request itself.
+  void ResetEventState();
+
+  // Restores all defaults so the object can be reused for another request.
+  void Reset();
+
  private:
   // Please don't add any more friends here if it can be avoided.
   // We should also remove the ones below.
@@ -94,7 +107,7 @@ struct BraveRequestInfo {
 
   // Don't use this directly after any dispatch
   // request is deprecated, do not use it.
-  const net::URLRequest* request;
+  const net::URLRequest* request = nullptr;
   GURL* new_url = nullptr;
 
   DISALLOW_COPY_AND_ASSIGN(BraveRequestInfo);
@@ -95,14 +95,16 @@ int64_t TorProfileServiceImpl::GetTorPid() {
 void TorProfileServiceImpl::SetProxy(net::ProxyResolutionService* service,
                                      const GURL& request_url,bool new_circuit) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  const TorConfig tor_config = tor_launcher_factory_->GetTorConfig();
+  const TorConfig& tor_config = tor_launcher_factory_->GetTorConfig();
+  if (tor_config.empty())
+    return;
   GURL url = SiteInstance::GetSiteForURL(profile_, request_url);
-  if (url.host().empty() || tor_config.empty())
+  if (url.host().empty())
     return;
-  base::PostTaskWithTraits(FROM_HERE, {BrowserThread::IO},
-      base::Bind(&TorProxyConfigService::TorSetProxy,
-      service, tor_config.proxy_string(),
-      url.host(), &tor_proxy_map_, new_circuit));
+  // already on the IO thread; the proxy service is only reset if the config
+  // for the site changed
+  TorProxyConfigService::TorSetProxy(service, tor_config.proxy_string(),
+                                     url.host(), &tor_proxy_map_, new_circuit);
 }
 
 void TorProfileServiceImpl::KillTor() {
@@ -76,13 +76,25 @@ void TorProxyConfigService::TorSetProxy(
     tor_proxy_map->Erase(site_url);
   std::unique_ptr<TorProxyConfigService>
     config(new TorProxyConfigService(tor_proxy, site_url, tor_proxy_map));
+
+  // Resetting the config service drops the state of the proxy service, so
+  // only do it when the proxy or the credentials of the site changed. This
+  // is called for every request in a tor window.
+  const auto& current_config = service->config();
+  if (current_config && config->IsValid() &&
+      current_config->value().Equals(config->config_))
+    return;
   service->ResetConfigService(std::move(config));
 }
 
+bool TorProxyConfigService::IsValid() const {
+  return scheme_ == kSocksProxy && !host_.empty() && !port_.empty();
+}
+
 TorProxyConfigService::ConfigAvailability
     TorProxyConfigService::GetLatestProxyConfig(
       net::ProxyConfigWithAnnotation* config) {
-  if (scheme_ != kSocksProxy || host_.empty() || port_.empty())
+  if (!IsValid())
     return CONFIG_UNSET;
   *config = net::ProxyConfigWithAnnotation(config_, NO_TRAFFIC_ANNOTATION_YET);
   return CONFIG_VALID;
@@ -69,6 +69,9 @@ class TorProxyConfigService : public net::ProxyConfigService {
     net::ProxyConfigWithAnnotation* config) override;
 
  private:
+  // Whether |config_| is a SOCKS proxy config.
+  bool IsValid() const;
+
   net::ProxyConfig config_;
 
   std::string scheme_;
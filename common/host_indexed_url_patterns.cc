@@ -0,0 +1,103 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/common/host_indexed_url_patterns.h"
+
+#include <algorithm>
+
+#include "url/gurl.h"
+
+namespace brave {
+
+HostIndexedURLPatterns::Entry::Entry(const URLPattern& pattern, size_t id)
+    : pattern(pattern), id(id) {
+}
+
+HostIndexedURLPatterns::HostIndexedURLPatterns() {
+}
+
+HostIndexedURLPatterns::HostIndexedURLPatterns(int valid_schemes,
+    const std::vector<const char*>& patterns) {
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    Add(URLPattern(valid_schemes, patterns[i]), i);
+  }
+}
+
+HostIndexedURLPatterns::~HostIndexedURLPatterns() {
+}
+
+void HostIndexedURLPatterns::Add(const URLPattern& pattern, size_t id) {
+  entries_.emplace_back(pattern, id);
+  const Entry* entry = &entries_.back();
+  const std::string& host = entry->pattern.host();
+  if (host.empty()) {
+    any_host_entries_.push_back(entry);
+  } else if (entry->pattern.match_subdomains()) {
+    subdomain_entries_[host].push_back(entry);
+  } else {
+    host_entries_[host].push_back(entry);
+  }
+}
+
+template <typename Callback>
+void HostIndexedURLPatterns::ForEachCandidate(const GURL& url,
+                                              Callback callback) const {
+  auto visit = [&callback](const EntryList& entries) {
+    for (const Entry* entry : entries) {
+      if (callback(entry)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto visit_host = [&visit](const EntryMap& entries, base::StringPiece host) {
+    if (entries.empty()) {
+      return false;
+    }
+    EntryMap::const_iterator i = entries.find(host);
+    return i != entries.end() && visit(i->second);
+  };
+
+  base::StringPiece host = url.host_piece();
+  if (!host.empty() && host.back() == '.') {
+    host.remove_suffix(1);
+  }
+  if (visit_host(host_entries_, host)) {
+    return;
+  }
+  for (;;) {
+    if (visit_host(subdomain_entries_, host)) {
+      return;
+    }
+    const size_t dot = host.find('.');
+    if (dot == base::StringPiece::npos) {
+      break;
+    }
+    host.remove_prefix(dot + 1);
+  }
+  visit(any_host_entries_);
+}
+
+bool HostIndexedURLPatterns::MatchesURL(const GURL& url) const {
+  bool matches = false;
+  ForEachCandidate(url, [&url, &matches](const Entry* entry) {
+    matches = entry->pattern.MatchesURL(url);
+    return matches;
+  });
+  return matches;
+}
+
+void HostIndexedURLPatterns::GetMatchingIDs(const GURL& url,
+    std::vector<size_t>* ids) const {
+  const size_t size = ids->size();
+  ForEachCandidate(url, [&url, ids](const Entry* entry) {
+    if (entry->pattern.MatchesURL(url)) {
+      ids->push_back(entry->id);
+    }
+    return false;
+  });
+  std::sort(ids->begin() + size, ids->end());
+}
+
+}  // namespace brave
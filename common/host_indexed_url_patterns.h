@@ -0,0 +1,67 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMMON_HOST_INDEXED_URL_PATTERNS_H_
+#define BRAVE_COMMON_HOST_INDEXED_URL_PATTERNS_H_
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "extensions/common/url_pattern.h"
+
+class GURL;
+
+namespace brave {
+
+// A set of URLPatterns indexed by host. A URL is only matched against the
+// patterns for its own host and, for "*." patterns, its parent domains, so
+// a URL no pattern is registered for costs one hash probe per host label,
+// without pattern matching or allocation.
+class HostIndexedURLPatterns {
+ public:
+  HostIndexedURLPatterns();
+  // Adds |patterns|, identified by their index.
+  HostIndexedURLPatterns(int valid_schemes,
+                         const std::vector<const char*>& patterns);
+  ~HostIndexedURLPatterns();
+
+  void Add(const URLPattern& pattern, size_t id);
+
+  bool MatchesURL(const GURL& url) const;
+  // Appends the ids of the patterns matching |url| to |ids|, in ascending
+  // order.
+  void GetMatchingIDs(const GURL& url, std::vector<size_t>* ids) const;
+
+ private:
+  struct Entry {
+    Entry(const URLPattern& pattern, size_t id);
+
+    URLPattern pattern;
+    size_t id;
+  };
+  using EntryList = std::vector<const Entry*>;
+  using EntryMap =
+      std::unordered_map<base::StringPiece, EntryList, base::StringPieceHash>;
+
+  // Calls |callback| with the entries that may match |url|, until it
+  // returns true.
+  template <typename Callback>
+  void ForEachCandidate(const GURL& url, Callback callback) const;
+
+  // Entries are never removed, so the keys of the maps below can point
+  // into their patterns.
+  std::deque<Entry> entries_;
+  EntryMap host_entries_;
+  EntryMap subdomain_entries_;
+  EntryList any_host_entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(HostIndexedURLPatterns);
+};
+
+}  // namespace brave
+
+#endif  // BRAVE_COMMON_HOST_INDEXED_URL_PATTERNS_H_
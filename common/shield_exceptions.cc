@@ -4,48 +4,36 @@
 
 #include "brave/common/shield_exceptions.h"
 
-#include <algorithm>
 #include <map>
+#include <string>
+#include <unordered_set>
 #include <vector>
 
+#include "base/no_destructor.h"
+#include "base/strings/string_piece.h"
+#include "brave/common/host_indexed_url_patterns.h"
 #include "extensions/common/url_pattern.h"
 #include "url/gurl.h"
 
 namespace brave {
 
 bool IsEmptyDataURLRedirect(const GURL& gurl) {
-  static std::vector<std::string> hosts({
+  static const base::NoDestructor<
+      std::unordered_set<base::StringPiece, base::StringPieceHash>> hosts({
     "sp1.nypost.com",
     "sp.nasdaq.com"
   });
-  return std::find(hosts.begin(), hosts.end(), gurl.host()) !=
-      hosts.end();
-}
-
-bool IsUAWhitelisted(const GURL& gurl) {
-  static std::vector<URLPattern> whitelist_patterns({
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.adobe.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.duckduckgo.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.brave.com/*"),
-    // For Widevine
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.netflix.com/*")
-  });
-  return std::any_of(whitelist_patterns.begin(), whitelist_patterns.end(),
-      [&gurl](URLPattern pattern){
-        return pattern.MatchesURL(gurl);
-      });
+  return hosts->count(gurl.host_piece()) != 0;
 }
 
 bool IsBlockedResource(const GURL& gurl) {
-  static std::vector<URLPattern> blocked_patterns({
-    URLPattern(URLPattern::SCHEME_ALL, "https://www.lesechos.fr/xtcore.js"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.y8.com/js/sdkloader/outstream.js"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://pdfjs.robwu.nl/*")
-  });
-  return std::any_of(blocked_patterns.begin(), blocked_patterns.end(),
-      [&gurl](URLPattern pattern){
-        return pattern.MatchesURL(gurl);
-      });
+  static const base::NoDestructor<HostIndexedURLPatterns> blocked_patterns(
+      URLPattern::SCHEME_ALL, std::vector<const char*>({
+    "https://www.lesechos.fr/xtcore.js",
+    "https://*.y8.com/js/sdkloader/outstream.js",
+    "https://pdfjs.robwu.nl/*"
+  }));
+  return blocked_patterns->MatchesURL(gurl);
 }
 
 bool IsWhitelistedReferrer(const GURL& firstPartyOrigin,
@@ -56,89 +44,71 @@ bool IsWhitelistedReferrer(const GURL& firstPartyOrigin,
   // https://github.com/brave/browser-laptop/issues/5861
   // The below patterns are done to only allow the specific request
   // pattern, of reddit -> redditmedia -> embedly -> imgur.
-  static auto redditPtrn = URLPattern(URLPattern::SCHEME_HTTPS, "https://www.reddit.com/*");
-  static std::vector<URLPattern> reddit_embed_patterns({
-    redditPtrn,
-    URLPattern(URLPattern::SCHEME_HTTPS, "https://www.redditmedia.com/*"),
-    URLPattern(URLPattern::SCHEME_HTTPS, "https://cdn.embedly.com/*"),
-    URLPattern(URLPattern::SCHEME_HTTPS, "https://imgur.com/*")
-  });
+  static const base::NoDestructor<URLPattern> redditPtrn(
+      URLPattern::SCHEME_HTTPS, "https://www.reddit.com/*");
+  static const base::NoDestructor<HostIndexedURLPatterns> reddit_embed_patterns(
+      URLPattern::SCHEME_HTTPS, std::vector<const char*>({
+    "https://www.reddit.com/*",
+    "https://www.redditmedia.com/*",
+    "https://cdn.embedly.com/*",
+    "https://imgur.com/*"
+  }));
 
-  if (redditPtrn.MatchesURL(firstPartyOrigin)) {
-    bool is_reddit_embed = std::any_of(
-      reddit_embed_patterns.begin(),
-      reddit_embed_patterns.end(),
-      [&subresourceUrl](URLPattern pattern){
-        return pattern.MatchesURL(subresourceUrl);
-      });
-    if (is_reddit_embed) {
-      return true;
-    }
+  if (redditPtrn->MatchesURL(firstPartyOrigin) &&
+      reddit_embed_patterns->MatchesURL(subresourceUrl)) {
+    return true;
   }
 
-  static std::map<GURL, std::vector<URLPattern> > whitelist_patterns_map = {{
-      GURL("https://www.facebook.com/"), {
-        URLPattern(URLPattern::SCHEME_HTTPS, "https://*.fbcdn.net/*"),
-      }
-    }
-  };
-  std::map<GURL, std::vector<URLPattern> >::iterator i =
-      whitelist_patterns_map.find(firstPartyOrigin);
-  if (i != whitelist_patterns_map.end()) {
-    std::vector<URLPattern> &exceptions = i->second;
-    bool any_match = std::any_of(exceptions.begin(), exceptions.end(),
-        [&subresourceUrl](const URLPattern& pattern) {
-          return pattern.MatchesURL(subresourceUrl);
-        });
-    if (any_match) {
-      return true;
-    }
+  static const base::NoDestructor<HostIndexedURLPatterns> facebook_patterns(
+      URLPattern::SCHEME_HTTPS, std::vector<const char*>({
+    "https://*.fbcdn.net/*"
+  }));
+  static const base::NoDestructor<
+      std::map<GURL, const HostIndexedURLPatterns*>> whitelist_patterns_map({
+    { GURL("https://www.facebook.com/"), facebook_patterns.get() }
+  });
+  auto i = whitelist_patterns_map->find(firstPartyOrigin);
+  if (i != whitelist_patterns_map->end() &&
+      i->second->MatchesURL(subresourceUrl)) {
+    return true;
   }
 
   // It's preferred to use specific_patterns below when possible
-  static std::vector<URLPattern> whitelist_patterns({
-    URLPattern(URLPattern::SCHEME_ALL, "https://use.typekit.net/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://api.geetest.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://cloud.typography.com/*")
-  });
-  return std::any_of(whitelist_patterns.begin(), whitelist_patterns.end(),
-    [&subresourceUrl](URLPattern pattern){
-      return pattern.MatchesURL(subresourceUrl);
-    });
+  static const base::NoDestructor<HostIndexedURLPatterns> whitelist_patterns(
+      URLPattern::SCHEME_ALL, std::vector<const char*>({
+    "https://use.typekit.net/*",
+    "https://api.geetest.com/*",
+    "https://cloud.typography.com/*"
+  }));
+  return whitelist_patterns->MatchesURL(subresourceUrl);
 }
 
 bool IsWhitelistedCookieExeption(const GURL& firstPartyOrigin,
     const GURL& subresourceUrl) {
   // Note that there's already an exception for TLD+1, so don't add those here.
   // Check with the security team before adding exceptions.
-  static std::map<GURL, std::vector<URLPattern> > whitelist_patterns = {};
-  std::map<GURL, std::vector<URLPattern> >::iterator i =
-      whitelist_patterns.find(firstPartyOrigin);
-  if (i == whitelist_patterns.end()) {
+  static const base::NoDestructor<
+      std::map<GURL, const HostIndexedURLPatterns*>> whitelist_patterns;
+  auto i = whitelist_patterns->find(firstPartyOrigin);
+  if (i == whitelist_patterns->end()) {
     return false;
   }
-  std::vector<URLPattern> &exceptions = i->second;
-  return std::any_of(exceptions.begin(), exceptions.end(),
-      [&subresourceUrl](const URLPattern& pattern) {
-        return pattern.MatchesURL(subresourceUrl);
-      });
+  return i->second->MatchesURL(subresourceUrl);
 }
 
 bool IsWidevineInstallableURL(const GURL& url) {
-  static std::vector<URLPattern> patterns({
-    URLPattern(URLPattern::SCHEME_ALL, "https://www.netflix.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://bitmovin.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://www.primevideo.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://www.spotify.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://shaka-player-demo.appspot.com/*"),
-    URLPattern(URLPattern::SCHEME_ALL, "https://*.hulu.com/*"),
+  static const base::NoDestructor<HostIndexedURLPatterns> patterns(
+      URLPattern::SCHEME_ALL, std::vector<const char*>({
+    "https://www.netflix.com/*",
+    "https://bitmovin.com/*",
+    "https://www.primevideo.com/*",
+    "https://www.spotify.com/*",
+    "https://shaka-player-demo.appspot.com/*",
+    "https://*.hulu.com/*",
     // Used for tests
-    URLPattern(URLPattern::SCHEME_ALL, "http://www.netflix.com:*/*")
-  });
-  return std::any_of(patterns.begin(), patterns.end(),
-    [&url](URLPattern pattern){
-      return pattern.MatchesURL(url);
-    });
+    "http://www.netflix.com:*/*"
+  }));
+  return patterns->MatchesURL(url);
 }
 
-}
+}  // namespace brave
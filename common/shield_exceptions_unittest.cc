@@ -43,6 +43,28 @@ TEST_F(BraveShieldsExceptionsTest, NotWidevineInstallableURL) {
   });
 }
 
+TEST_F(BraveShieldsExceptionsTest, BlockedResource) {
+  EXPECT_TRUE(brave::IsBlockedResource(
+      GURL("https://www.lesechos.fr/xtcore.js")));
+  EXPECT_TRUE(brave::IsBlockedResource(
+      GURL("https://cdn.y8.com/js/sdkloader/outstream.js")));
+  EXPECT_TRUE(brave::IsBlockedResource(GURL("https://pdfjs.robwu.nl/x.pdf")));
+  // The path has to match too
+  EXPECT_FALSE(brave::IsBlockedResource(
+      GURL("https://www.lesechos.fr/other.js")));
+  EXPECT_FALSE(brave::IsBlockedResource(
+      GURL("https://cdn.y8.com/js/sdkloader/other.js")));
+  EXPECT_FALSE(brave::IsBlockedResource(GURL("https://lesechos.fr/xtcore.js")));
+}
+
+TEST_F(BraveShieldsExceptionsTest, EmptyDataURLRedirect) {
+  EXPECT_TRUE(brave::IsEmptyDataURLRedirect(GURL("https://sp1.nypost.com/")));
+  EXPECT_TRUE(brave::IsEmptyDataURLRedirect(GURL("http://sp.nasdaq.com/a")));
+  EXPECT_FALSE(brave::IsEmptyDataURLRedirect(GURL("https://nypost.com/")));
+  EXPECT_FALSE(brave::IsEmptyDataURLRedirect(
+      GURL("https://x.sp.nasdaq.com/")));
+}
+
 TEST_F(BraveShieldsExceptionsTest, IsWhitelistedReferrer) {
   // *.fbcdn.net not allowed on some other URL
   EXPECT_FALSE(IsWhitelistedReferrer(GURL("https://test.com"),
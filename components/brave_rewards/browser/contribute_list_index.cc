@@ -0,0 +1,200 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_rewards/browser/contribute_list_index.h"
+
+#include <limits.h>
+
+#include <utility>
+
+#include "brave/components/brave_rewards/browser/publisher_info_database.h"
+
+namespace brave_rewards {
+
+namespace {
+
+const char kPercentColumn[] = "ai.percent";
+
+bool MatchesFilter(const ledger::PublisherInfo& info,
+                   const ledger::PublisherInfoFilter& filter) {
+  if (filter.min_duration > 0 && info.duration < filter.min_duration)
+    return false;
+
+  switch (filter.excluded) {
+    case ledger::PUBLISHER_EXCLUDE_FILTER::FILTER_ALL:
+      return true;
+    case ledger::PUBLISHER_EXCLUDE_FILTER::FILTER_ALL_EXCEPT_EXCLUDED:
+      return info.excluded != ledger::PUBLISHER_EXCLUDE::EXCLUDED;
+    default:
+      return static_cast<int>(info.excluded) ==
+          static_cast<int>(filter.excluded);
+  }
+}
+
+}  // namespace
+
+bool ContributeListIndex::EntryOrder::operator()(const Entry* left,
+                                                 const Entry* right) const {
+  // ORDER BY ai.percent DESC, ai.rowid ASC
+  if (left->info.percent != right->info.percent)
+    return left->info.percent > right->info.percent;
+  return left->rowid < right->rowid;
+}
+
+ContributeListIndex::ContributeListIndex()
+    : loaded_(false),
+      reconcile_stamp_(0) {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+ContributeListIndex::~ContributeListIndex() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+// static
+bool ContributeListIndex::IsContributeListFilter(
+    const ledger::PublisherInfoFilter& filter) {
+  return filter.id.empty() &&
+      filter.category == ledger::PUBLISHER_CATEGORY::AUTO_CONTRIBUTE &&
+      filter.month == ledger::PUBLISHER_MONTH::ANY &&
+      filter.year <= 0 &&
+      filter.reconcile_stamp > 0 &&
+      filter.order_by.size() == 1 &&
+      filter.order_by.front().first == kPercentColumn &&
+      !filter.order_by.front().second;
+}
+
+bool ContributeListIndex::Load(uint64_t reconcile_stamp,
+                               PublisherInfoDatabase* backend) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  if (loaded_ && reconcile_stamp_ == reconcile_stamp)
+    return true;
+
+  Clear();
+  if (!backend)
+    return false;
+
+  ledger::PublisherInfoFilter filter;
+  filter.category = ledger::PUBLISHER_CATEGORY::AUTO_CONTRIBUTE;
+  filter.month = ledger::PUBLISHER_MONTH::ANY;
+  filter.year = -1;
+  filter.reconcile_stamp = reconcile_stamp;
+  filter.min_duration = 0;
+  filter.excluded = ledger::PUBLISHER_EXCLUDE_FILTER::FILTER_ALL;
+  filter.order_by.push_back(std::make_pair(kPercentColumn, false));
+
+  ledger::PublisherInfoList list;
+  std::vector<int64_t> rowids;
+  if (!backend->Find(0, 0, filter, &list, &rowids))
+    return false;
+  DCHECK_EQ(list.size(), rowids.size());
+
+  loaded_ = true;
+  reconcile_stamp_ = reconcile_stamp;
+  for (size_t i = 0; i < list.size(); ++i)
+    Insert(list[i], rowids[i]);
+  return true;
+}
+
+void ContributeListIndex::Update(const ledger::PublisherInfoList& list,
+                                 PublisherInfoDatabase* backend) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  if (!loaded_)
+    return;
+
+  for (const auto& info : list) {
+    // saves without a month only touch the publisher, see
+    // PublisherInfoDatabase::UpsertPublisherInfo()
+    if (info.category == ledger::PUBLISHER_CATEGORY::AUTO_CONTRIBUTE &&
+        info.reconcile_stamp == reconcile_stamp_ &&
+        info.month != ledger::PUBLISHER_MONTH::ANY && info.year != -1 &&
+        !Upsert(info, backend)) {
+      // the period is read again by the next Load()
+      Clear();
+      return;
+    }
+    UpdatePublisher(info);
+  }
+}
+
+void ContributeListIndex::Find(int start,
+                               int limit,
+                               const ledger::PublisherInfoFilter& filter,
+                               ledger::PublisherInfoList* list) const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(loaded_);
+  DCHECK(IsContributeListFilter(filter));
+  DCHECK_EQ(filter.reconcile_stamp, reconcile_stamp_);
+
+  // like the database, a start of 1 reads from the first entry
+  const int offset = start > 1 ? start : 0;
+  int skipped = 0;
+  int count = 0;
+  for (const Entry* entry : sorted_entries_) {
+    if (limit > 0 && count == limit)
+      break;
+    if (!MatchesFilter(entry->info, filter))
+      continue;
+    if (skipped < offset) {
+      ++skipped;
+      continue;
+    }
+    list->push_back(entry->info);
+    ++count;
+  }
+}
+
+void ContributeListIndex::Clear() {
+  loaded_ = false;
+  reconcile_stamp_ = 0;
+  sorted_entries_.clear();
+  entries_.clear();
+}
+
+void ContributeListIndex::Insert(const ledger::PublisherInfo& info,
+                                 int64_t rowid) {
+  std::unique_ptr<Entry> entry(new Entry{info, rowid});
+  sorted_entries_.insert(entry.get());
+  entries_[EntryKey(info.id, info.month, info.year)] = std::move(entry);
+}
+
+bool ContributeListIndex::Upsert(const ledger::PublisherInfo& info,
+                                 PublisherInfoDatabase* backend) {
+  auto it = entries_.find(EntryKey(info.id, info.month, info.year));
+  if (it == entries_.end()) {
+    const int64_t rowid = backend ? backend->GetActivityInfoRowId(info) : 0;
+    if (!rowid)
+      return false;
+    Insert(info, rowid);
+    return true;
+  }
+
+  // only the entry that changed is moved, the rest of the order stands
+  Entry* entry = it->second.get();
+  sorted_entries_.erase(entry);
+  entry->info.duration = info.duration;
+  entry->info.score = info.score;
+  entry->info.percent = info.percent;
+  entry->info.weight = info.weight;
+  sorted_entries_.insert(entry);
+  return true;
+}
+
+void ContributeListIndex::UpdatePublisher(const ledger::PublisherInfo& info) {
+  // every activity entry of the publisher shares its publisher_info row
+  for (auto it = entries_.lower_bound(EntryKey(info.id, INT_MIN, INT_MIN));
+       it != entries_.end() && std::get<0>(it->first) == info.id; ++it) {
+    ledger::PublisherInfo& entry_info = it->second->info;
+    entry_info.verified = info.verified;
+    entry_info.excluded = info.excluded;
+    entry_info.name = info.name;
+    entry_info.url = info.url;
+    entry_info.provider = info.provider;
+    entry_info.favicon_url = info.favicon_url;
+  }
+}
+
+}  // namespace brave_rewards
@@ -0,0 +1,95 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_CONTRIBUTE_LIST_INDEX_H_
+#define BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_CONTRIBUTE_LIST_INDEX_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/sequence_checker.h"
+#include "bat/ledger/publisher_info.h"
+
+namespace brave_rewards {
+
+class PublisherInfoDatabase;
+
+// In-memory copy of the auto contribute activity of one reconcile period,
+// kept sorted by percent, so that the contribute list can be paged without
+// querying the database. It's loaded from the database once per period and
+// then kept up to date with the publisher info that is written to it.
+//
+// Like PublisherInfoDatabase, it must be used on a single sequence.
+class ContributeListIndex {
+ public:
+  ContributeListIndex();
+  ~ContributeListIndex();
+
+  // Whether Find() can answer |filter|, i.e. it selects the auto contribute
+  // activity of a reconcile period, sorted by descending percent.
+  static bool IsContributeListFilter(const ledger::PublisherInfoFilter& filter);
+
+  // Loads the activity of |reconcile_stamp| from |backend|, unless that
+  // period is already loaded. Returns false if it couldn't be read.
+  bool Load(uint64_t reconcile_stamp, PublisherInfoDatabase* backend);
+
+  // Applies |list|, which has been saved to |backend|.
+  void Update(const ledger::PublisherInfoList& list,
+              PublisherInfoDatabase* backend);
+
+  // Appends up to |limit| entries, or all of them if |limit| is 0, matching
+  // |filter| from the |start|th one. Returns the same rows, in the same
+  // order, as PublisherInfoDatabase::Find(). |filter| must be a contribute
+  // list filter for the loaded period.
+  void Find(int start,
+            int limit,
+            const ledger::PublisherInfoFilter& filter,
+            ledger::PublisherInfoList* list) const;
+
+  bool is_loaded() const { return loaded_; }
+  uint64_t reconcile_stamp() const { return reconcile_stamp_; }
+
+ private:
+  struct Entry {
+    ledger::PublisherInfo info;
+    // The rowid of its activity_info row, which breaks ties like in the
+    // database
+    int64_t rowid;
+  };
+
+  struct EntryOrder {
+    bool operator()(const Entry* left, const Entry* right) const;
+  };
+
+  // publisher id, month and year
+  using EntryKey = std::tuple<std::string, int, int>;
+
+  void Clear();
+  void Insert(const ledger::PublisherInfo& info, int64_t rowid);
+  // Returns false if |info| is new and its rowid can't be read.
+  bool Upsert(const ledger::PublisherInfo& info,
+              PublisherInfoDatabase* backend);
+  void UpdatePublisher(const ledger::PublisherInfo& info);
+
+  bool loaded_;
+  uint64_t reconcile_stamp_;
+  std::map<EntryKey, std::unique_ptr<Entry>> entries_;
+  // |entries_| in descending percent order
+  std::set<const Entry*, EntryOrder> sorted_entries_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  DISALLOW_COPY_AND_ASSIGN(ContributeListIndex);
+};
+
+}  // namespace brave_rewards
+
+#endif  // BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_CONTRIBUTE_LIST_INDEX_H_
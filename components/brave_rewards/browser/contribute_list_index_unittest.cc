@@ -0,0 +1,186 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_rewards/browser/contribute_list_index.h"
+
+#include <string>
+#include <utility>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "brave/components/brave_rewards/browser/publisher_info_database.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=ContributeListIndexTest.*
+
+namespace brave_rewards {
+
+namespace {
+
+const uint64_t kReconcileStamp = 1;
+
+ledger::PublisherInfo MakeInfo(int i, ledger::PUBLISHER_MONTH month) {
+  ledger::PublisherInfo info("publisher" + base::IntToString(i), month, 2019);
+  info.category = ledger::PUBLISHER_CATEGORY::AUTO_CONTRIBUTE;
+  info.reconcile_stamp = kReconcileStamp;
+  info.duration = 10 * (i % 7);
+  info.percent = i % 5;
+  info.name = info.id;
+  return info;
+}
+
+}  // namespace
+
+class ContributeListIndexTest : public testing::Test {
+ public:
+  ContributeListIndexTest() {}
+  ~ContributeListIndexTest() override {}
+
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    database_.reset(new PublisherInfoDatabase(
+        temp_dir_.GetPath().AppendASCII("publisher_info_db")));
+  }
+
+  void Save(const ledger::PublisherInfoList& list) {
+    ASSERT_TRUE(database_->InsertOrUpdatePublisherInfoList(list));
+    index_.Update(list, database_.get());
+  }
+
+  ledger::PublisherInfoFilter ContributeFilter() {
+    ledger::PublisherInfoFilter filter;
+    filter.category = ledger::PUBLISHER_CATEGORY::AUTO_CONTRIBUTE;
+    filter.month = ledger::PUBLISHER_MONTH::ANY;
+    filter.year = -1;
+    filter.reconcile_stamp = kReconcileStamp;
+    filter.min_duration = 20;
+    filter.excluded =
+        ledger::PUBLISHER_EXCLUDE_FILTER::FILTER_ALL_EXCEPT_EXCLUDED;
+    filter.order_by.push_back(std::make_pair("ai.percent", false));
+    return filter;
+  }
+
+  // The index must page exactly like the database
+  void ExpectSameAsDatabase(int start, int limit) {
+    const ledger::PublisherInfoFilter filter = ContributeFilter();
+    ledger::PublisherInfoList expected;
+    ASSERT_TRUE(database_->Find(start, limit, filter, &expected));
+    ledger::PublisherInfoList list;
+    index_.Find(start, limit, filter, &list);
+
+    ASSERT_EQ(list.size(), expected.size());
+    for (size_t i = 0; i < list.size(); ++i) {
+      EXPECT_EQ(list[i].id, expected[i].id);
+      EXPECT_EQ(list[i].month, expected[i].month);
+      EXPECT_EQ(list[i].percent, expected[i].percent);
+      EXPECT_EQ(list[i].duration, expected[i].duration);
+      EXPECT_EQ(list[i].excluded, expected[i].excluded);
+      EXPECT_EQ(list[i].name, expected[i].name);
+    }
+  }
+
+  base::ScopedTempDir temp_dir_;
+  std::unique_ptr<PublisherInfoDatabase> database_;
+  ContributeListIndex index_;
+};
+
+TEST_F(ContributeListIndexTest, IsContributeListFilter) {
+  ledger::PublisherInfoFilter filter = ContributeFilter();
+  EXPECT_TRUE(ContributeListIndex::IsContributeListFilter(filter));
+
+  filter.id = "publisher1";
+  EXPECT_FALSE(ContributeListIndex::IsContributeListFilter(filter));
+
+  filter = ContributeFilter();
+  filter.month = ledger::PUBLISHER_MONTH::JANUARY;
+  EXPECT_FALSE(ContributeListIndex::IsContributeListFilter(filter));
+
+  filter = ContributeFilter();
+  filter.order_by.clear();
+  EXPECT_FALSE(ContributeListIndex::IsContributeListFilter(filter));
+}
+
+TEST_F(ContributeListIndexTest, FollowsSaves) {
+  ledger::PublisherInfoList list;
+  for (int i = 0; i < 100; ++i)
+    list.push_back(MakeInfo(i, ledger::PUBLISHER_MONTH::JANUARY));
+  Save(list);
+
+  ASSERT_TRUE(index_.Load(kReconcileStamp, database_.get()));
+  ExpectSameAsDatabase(0, 0);
+  ExpectSameAsDatabase(1, 10);
+  ExpectSameAsDatabase(10, 25);
+
+  // new rows, rows of another month and updated rows
+  list.clear();
+  for (int i = 0; i < 100; i += 3) {
+    ledger::PublisherInfo info = MakeInfo(i, ledger::PUBLISHER_MONTH::JANUARY);
+    info.percent = (i * 7) % 5;
+    info.duration += 30;
+    list.push_back(info);
+  }
+  for (int i = 100; i < 120; ++i)
+    list.push_back(MakeInfo(i, ledger::PUBLISHER_MONTH::JANUARY));
+  for (int i = 0; i < 20; ++i)
+    list.push_back(MakeInfo(i, ledger::PUBLISHER_MONTH::FEBRUARY));
+  Save(list);
+  ExpectSameAsDatabase(0, 0);
+
+  // excluding a publisher excludes all of its rows
+  ledger::PublisherInfo excluded("publisher4", ledger::PUBLISHER_MONTH::ANY,
+                                 -1);
+  excluded.excluded = ledger::PUBLISHER_EXCLUDE::EXCLUDED;
+  Save(ledger::PublisherInfoList(1, excluded));
+  ExpectSameAsDatabase(0, 0);
+  ExpectSameAsDatabase(30, 50);
+
+  // rows of another period are left to the database
+  ledger::PublisherInfo other = MakeInfo(200, ledger::PUBLISHER_MONTH::MARCH);
+  other.reconcile_stamp = kReconcileStamp + 1;
+  Save(ledger::PublisherInfoList(1, other));
+  ExpectSameAsDatabase(0, 0);
+
+  ASSERT_TRUE(index_.Load(kReconcileStamp + 1, database_.get()));
+  ledger::PublisherInfoFilter filter = ContributeFilter();
+  filter.reconcile_stamp = kReconcileStamp + 1;
+  ledger::PublisherInfoList found;
+  index_.Find(0, 0, filter, &found);
+  ASSERT_EQ(found.size(), 1u);
+  EXPECT_EQ(found[0].id, "publisher200");
+}
+
+TEST_F(ContributeListIndexTest, TiesFollowRowids) {
+  // A is saved before B, so it sorts first among equal percents even once
+  // B was loaded before it
+  ledger::PublisherInfo a = MakeInfo(1, ledger::PUBLISHER_MONTH::JANUARY);
+  a.duration = 30;
+  a.percent = 5;
+  ledger::PublisherInfo b = MakeInfo(2, ledger::PUBLISHER_MONTH::JANUARY);
+  b.duration = 30;
+  b.percent = 10;
+  Save(ledger::PublisherInfoList({a, b}));
+
+  ASSERT_TRUE(index_.Load(kReconcileStamp, database_.get()));
+  ExpectSameAsDatabase(0, 0);
+
+  b.percent = 5;
+  Save(ledger::PublisherInfoList(1, b));
+  ExpectSameAsDatabase(0, 0);
+
+  ledger::PublisherInfoList list;
+  index_.Find(0, 0, ContributeFilter(), &list);
+  ASSERT_EQ(list.size(), 2u);
+  EXPECT_EQ(list[0].id, a.id);
+  EXPECT_EQ(list[1].id, b.id);
+
+  // a new row sorts after both
+  ledger::PublisherInfo c = MakeInfo(3, ledger::PUBLISHER_MONTH::JANUARY);
+  c.duration = 30;
+  c.percent = 5;
+  Save(ledger::PublisherInfoList(1, c));
+  ExpectSameAsDatabase(0, 0);
+}
+
+}  // namespace brave_rewards
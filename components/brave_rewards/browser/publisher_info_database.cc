@@ -22,7 +22,7 @@ namespace brave_rewards {
 
 namespace {
 
-const int kCurrentVersionNumber = 2;
+const int kCurrentVersionNumber = 3;
 const int kCompatibleVersionNumber = 1;
 
 }  // namespace
@@ -68,6 +68,9 @@ bool PublisherInfoDatabase::Init() {
   if (version_status != sql::INIT_OK)
     return version_status;
 
+  // reconcile_stamp is only there once migrated
+  CreateActivityInfoFilterIndexes();
+
   if (!committer.Commit())
     return false;
 
@@ -163,7 +166,11 @@ bool PublisherInfoDatabase::CreateActivityInfoTable() {
       "    FOREIGN KEY (publisher_id)"
       "    REFERENCES publisher_info (publisher_id)"
       "    ON DELETE CASCADE)");
-  return GetDB().Execute(sql.c_str());
+  if (!GetDB().Execute(sql.c_str()))
+    return false;
+
+  // existing tables get the index once MigrateV2toV3() removed duplicates
+  return CreateActivityInfoUniqueIndex();
 }
 
 bool PublisherInfoDatabase::CreateActivityInfoIndex() {
@@ -174,6 +181,31 @@ bool PublisherInfoDatabase::CreateActivityInfoIndex() {
       "ON activity_info (publisher_id)");
 }
 
+bool PublisherInfoDatabase::CreateActivityInfoFilterIndexes() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  // Index the filter columns of the contribution list, which also sorts by
+  // percent, and of the monthly reports. The other columns they read still
+  // come from the table.
+  return GetDB().Execute(
+      "CREATE INDEX IF NOT EXISTS activity_info_reconcile_stamp_index "
+      "ON activity_info "
+      "(category, reconcile_stamp, percent, duration, publisher_id)") &&
+      GetDB().Execute(
+      "CREATE INDEX IF NOT EXISTS activity_info_month_year_index "
+      "ON activity_info (category, month, year, duration, publisher_id)");
+}
+
+bool PublisherInfoDatabase::CreateActivityInfoUniqueIndex() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  // InsertOrUpdatePublisherInfo() upserts on this index
+  return GetDB().Execute(
+      "CREATE UNIQUE INDEX IF NOT EXISTS activity_info_unique_index "
+      "ON activity_info "
+      "(publisher_id, category, month, year, reconcile_stamp)");
+}
+
 bool PublisherInfoDatabase::CreateMediaPublisherInfoTable() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
@@ -230,6 +262,11 @@ bool PublisherInfoDatabase::CreateRecurringDonationIndex() {
 
 bool PublisherInfoDatabase::InsertOrUpdatePublisherInfo(
     const ledger::PublisherInfo& info) {
+  return InsertOrUpdatePublisherInfoList(ledger::PublisherInfoList(1, info));
+}
+
+bool PublisherInfoDatabase::InsertOrUpdatePublisherInfoList(
+    const ledger::PublisherInfoList& list) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
   bool initialized = Init();
@@ -238,12 +275,33 @@ bool PublisherInfoDatabase::InsertOrUpdatePublisherInfo(
   if (!initialized)
     return false;
 
+  // One transaction, and so one sync to disk, for the whole list
+  sql::Transaction transaction(&GetDB());
+  if (!transaction.Begin())
+    return false;
+
+  for (const auto& info : list) {
+    if (!UpsertPublisherInfo(info))
+      return false;
+  }
+
+  return transaction.Commit();
+}
+
+bool PublisherInfoDatabase::UpsertPublisherInfo(
+    const ledger::PublisherInfo& info) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
   sql::Statement publisher_info_statement(
       GetDB().GetCachedStatement(SQL_FROM_HERE,
-          "INSERT OR REPLACE INTO publisher_info "
+          "INSERT INTO publisher_info "
           "(publisher_id, verified, excluded, "
           "name, url, provider, favIcon) "
-          "VALUES (?, ?, ?, ?, ?, ?, ?)"));
+          "VALUES (?, ?, ?, ?, ?, ?, ?) "
+          "ON CONFLICT (publisher_id) DO UPDATE SET "
+          "verified=excluded.verified, excluded=excluded.excluded, "
+          "name=excluded.name, url=excluded.url, "
+          "provider=excluded.provider, favIcon=excluded.favIcon"));
 
   publisher_info_statement.BindString(0, info.id);
   publisher_info_statement.BindBool(1, info.verified);
@@ -261,57 +319,28 @@ bool PublisherInfoDatabase::InsertOrUpdatePublisherInfo(
     return true;
   }
 
-  sql::Statement activity_get(
-      db_.GetUniqueStatement("SELECT publisher_id FROM activity_info WHERE "
-                             "publisher_id=? AND category=? "
-                             "AND month=? AND year=? AND reconcile_stamp=?"));
-
-  activity_get.BindString(0, info.id);
-  activity_get.BindInt(1, info.category);
-  activity_get.BindInt(2, info.month);
-  activity_get.BindInt(3, info.year);
-  activity_get.BindInt64(4, info.reconcile_stamp);
-
-  if (activity_get.Step()) {
-    sql::Statement activity_info_update(
-      GetDB().GetCachedStatement(SQL_FROM_HERE,
-          "UPDATE activity_info SET "
-          "duration=?, score=?, percent=?, "
-          "weight=? WHERE "
-          "publisher_id=? AND category=? "
-          "AND month=? AND year=? AND reconcile_stamp=?"));
-
-    activity_info_update.BindInt64(0, (int)info.duration);
-    activity_info_update.BindDouble(1, info.score);
-    activity_info_update.BindInt64(2, (int)info.percent);
-    activity_info_update.BindDouble(3, info.weight);
-    activity_info_update.BindString(4, info.id);
-    activity_info_update.BindInt(5, info.category);
-    activity_info_update.BindInt(6, info.month);
-    activity_info_update.BindInt(7, info.year);
-    activity_info_update.BindInt64(8, info.reconcile_stamp);
-
-    return activity_info_update.Run();
-  }
-
-  sql::Statement activity_info_insert(
+  sql::Statement activity_info_upsert(
     GetDB().GetCachedStatement(SQL_FROM_HERE,
         "INSERT INTO activity_info "
         "(publisher_id, duration, score, percent, "
         "weight, category, month, year, reconcile_stamp) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)"));
-
-  activity_info_insert.BindString(0, info.id);
-  activity_info_insert.BindInt64(1, (int)info.duration);
-  activity_info_insert.BindDouble(2, info.score);
-  activity_info_insert.BindInt64(3, (int)info.percent);
-  activity_info_insert.BindDouble(4, info.weight);
-  activity_info_insert.BindInt(5, info.category);
-  activity_info_insert.BindInt(6, info.month);
-  activity_info_insert.BindInt(7, info.year);
-  activity_info_insert.BindInt64(8, info.reconcile_stamp);
-
-  return activity_info_insert.Run();
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?) "
+        "ON CONFLICT (publisher_id, category, month, year, reconcile_stamp) "
+        "DO UPDATE SET "
+        "duration=excluded.duration, score=excluded.score, "
+        "percent=excluded.percent, weight=excluded.weight"));
+
+  activity_info_upsert.BindString(0, info.id);
+  activity_info_upsert.BindInt64(1, (int)info.duration);
+  activity_info_upsert.BindDouble(2, info.score);
+  activity_info_upsert.BindInt64(3, (int)info.percent);
+  activity_info_upsert.BindDouble(4, info.weight);
+  activity_info_upsert.BindInt(5, info.category);
+  activity_info_upsert.BindInt(6, info.month);
+  activity_info_upsert.BindInt(7, info.year);
+  activity_info_upsert.BindInt64(8, info.reconcile_stamp);
+
+  return activity_info_upsert.Run();
 }
 
 bool PublisherInfoDatabase::InsertOrUpdateMediaPublisherInfo(
@@ -373,6 +402,14 @@ bool PublisherInfoDatabase::Find(int start,
                                  int limit,
                                  const ledger::PublisherInfoFilter& filter,
                                  ledger::PublisherInfoList* list) {
+  return Find(start, limit, filter, list, nullptr);
+}
+
+bool PublisherInfoDatabase::Find(int start,
+                                 int limit,
+                                 const ledger::PublisherInfoFilter& filter,
+                                 ledger::PublisherInfoList* list,
+                                 std::vector<int64_t>* rowids) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
   CHECK(list);
@@ -383,19 +420,57 @@ bool PublisherInfoDatabase::Find(int start,
   if (!initialized)
     return false;
 
+  // Rows are sorted by a single column and the rowid, so a page that
+  // follows the previous one can seek past its last row instead of
+  // stepping over |start| rows.
+  // |start| only applies from 2 on, a start of 1 reads from the first row
+  const int offset = start > 1 ? start : 0;
+  const bool sorted_by_key = filter.order_by.size() == 1;
+  const bool seek = sorted_by_key && limit > 0 && offset > 0 &&
+      find_cursor_ && find_cursor_->next_start == offset &&
+      IsSameFilter(find_cursor_->filter, filter);
+
   std::string query = "SELECT ai.publisher_id, ai.duration, ai.score, ai.percent, "
       "ai.weight, pi.verified, pi.excluded, ai.category, ai.month, ai.year, pi.name, "
-      "pi.url, pi.provider, pi.favIcon, ai.reconcile_stamp "
-      "FROM activity_info AS ai "
+      "pi.url, pi.provider, pi.favIcon, ai.reconcile_stamp, ai.rowid";
+  if (sorted_by_key)
+    query += ", " + filter.order_by.front().first;
+  query += " FROM activity_info AS ai "
       "INNER JOIN publisher_info AS pi ON ai.publisher_id = pi.publisher_id "
       "WHERE 1 = 1";
 
-  query+= BuildClauses(start, limit, filter);
+  query += BuildClauses(filter);
+  if (seek) {
+    const std::string& column = filter.order_by.front().first;
+    query += " AND (" + column +
+        (filter.order_by.front().second ? " > ?" : " < ?") +
+        " OR (" + column + " = ? AND ai.rowid > ?))";
+  }
+  query += BuildOrderBy(filter);
+  if (limit > 0) {
+    query += " LIMIT ?";
+    if (offset > 0 && !seek)
+      query += " OFFSET ?";
+  }
 
-  sql::Statement info_sql(db_.GetUniqueStatement(query.c_str()));
+  sql::Statement info_sql(GetCachedQueryStatement(query));
 
-  BindFilter(info_sql, filter);
+  int column = BindFilter(info_sql, filter);
+  if (seek) {
+    info_sql.BindDouble(column++, find_cursor_->sort_key);
+    info_sql.BindDouble(column++, find_cursor_->sort_key);
+    info_sql.BindInt64(column++, find_cursor_->rowid);
+  }
+  if (limit > 0) {
+    info_sql.BindInt(column++, limit);
+    if (offset > 0 && !seek)
+      info_sql.BindInt(column++, offset);
+  }
 
+  bool has_cursor = false;
+  double sort_key = 0;
+  int64_t rowid = 0;
+  int count = 0;
   while (info_sql.Step()) {
     std::string id(info_sql.ColumnString(0));
     ledger::PUBLISHER_MONTH month(
@@ -420,11 +495,57 @@ bool PublisherInfoDatabase::Find(int start,
         static_cast<ledger::PUBLISHER_CATEGORY>(info_sql.ColumnInt(7));
 
     list->push_back(info);
+
+    rowid = info_sql.ColumnInt64(15);
+    if (rowids)
+      rowids->push_back(rowid);
+
+    // only numeric sort keys can be sought from
+    has_cursor = sorted_by_key &&
+        (info_sql.ColumnType(16) == sql::COLUMN_TYPE_INTEGER ||
+         info_sql.ColumnType(16) == sql::COLUMN_TYPE_FLOAT);
+    if (has_cursor)
+      sort_key = info_sql.ColumnDouble(16);
+    ++count;
+  }
+
+  find_cursor_.reset();
+  if (has_cursor && limit > 0 && count == limit) {
+    find_cursor_.emplace();
+    find_cursor_->filter = filter;
+    find_cursor_->next_start = offset + count;
+    find_cursor_->sort_key = sort_key;
+    find_cursor_->rowid = rowid;
   }
 
   return list;
 }
 
+int64_t PublisherInfoDatabase::GetActivityInfoRowId(
+    const ledger::PublisherInfo& info) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  bool initialized = Init();
+  DCHECK(initialized);
+
+  if (!initialized)
+    return 0;
+
+  sql::Statement statement(GetDB().GetCachedStatement(SQL_FROM_HERE,
+      "SELECT rowid FROM activity_info "
+      "WHERE publisher_id = ? AND category = ? AND month = ? AND year = ? "
+      "AND reconcile_stamp = ?"));
+  statement.BindString(0, info.id);
+  statement.BindInt(1, info.category);
+  statement.BindInt(2, info.month);
+  statement.BindInt(3, info.year);
+  statement.BindInt64(4, info.reconcile_stamp);
+
+  if (!statement.Step())
+    return 0;
+  return statement.ColumnInt64(0);
+}
+
 int PublisherInfoDatabase::Count(const ledger::PublisherInfoFilter& filter) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
@@ -439,9 +560,9 @@ int PublisherInfoDatabase::Count(const ledger::PublisherInfoFilter& filter) {
       "INNER JOIN publisher_info AS pi ON ai.publisher_id = pi.publisher_id "
       "WHERE 1 = 1";
 
-  query+= BuildClauses(0, 0, filter);
+  query += BuildClauses(filter);
 
-  sql::Statement publisher_count(db_.GetUniqueStatement(query.c_str()));
+  sql::Statement publisher_count(GetCachedQueryStatement(query));
 
   BindFilter(publisher_count, filter);
 
@@ -451,9 +572,18 @@ int PublisherInfoDatabase::Count(const ledger::PublisherInfoFilter& filter) {
   return publisher_count.ColumnInt(0);
 }
 
-std::string PublisherInfoDatabase::BuildClauses(int start,
-                                                int limit,
-                                                const ledger::PublisherInfoFilter& filter) {
+scoped_refptr<sql::Database::StatementRef>
+PublisherInfoDatabase::GetCachedQueryStatement(const std::string& query) {
+  // The query text only depends on the shape of the filter, so there is a
+  // small, fixed set of them. The cache keys on the text, which has to
+  // outlive the statement.
+  const std::string& cached_query = *cached_queries_.insert(query).first;
+  return GetDB().GetCachedStatement(
+      sql::StatementID(cached_query.c_str(), 0), cached_query.c_str());
+}
+
+std::string PublisherInfoDatabase::BuildClauses(
+    const ledger::PublisherInfoFilter& filter) {
   std::string clauses = "";
 
   if (!filter.id.empty())
@@ -483,24 +613,26 @@ std::string PublisherInfoDatabase::BuildClauses(int start,
     ledger::PUBLISHER_EXCLUDE_FILTER::FILTER_ALL_EXCEPT_EXCLUDED)
     clauses += " AND pi.excluded != ?";
 
-  for (const auto& it : filter.order_by) {
-    clauses += " ORDER BY " + it.first;
-    clauses += (it.second ? " ASC" : " DESC");
-  }
-
-  if (limit > 0) {
-    clauses += " LIMIT " + std::to_string(limit);
+  return clauses;
+}
 
-    if (start > 1) {
-      clauses += " OFFSET " + std::to_string(start);
-    }
+std::string PublisherInfoDatabase::BuildOrderBy(
+    const ledger::PublisherInfoFilter& filter) {
+  std::string order_by;
+  for (const auto& it : filter.order_by) {
+    order_by += order_by.empty() ? " ORDER BY " : ", ";
+    order_by += it.first;
+    order_by += (it.second ? " ASC" : " DESC");
   }
 
-  return clauses;
+  // the rowid makes the order total, for paging
+  if (!order_by.empty())
+    order_by += ", ai.rowid ASC";
+  return order_by;
 }
 
-void PublisherInfoDatabase::BindFilter(sql::Statement& statement,
-                                       const ledger::PublisherInfoFilter& filter) {
+int PublisherInfoDatabase::BindFilter(sql::Statement& statement,
+                                      const ledger::PublisherInfoFilter& filter) {
   int column = 0;
   if (!filter.id.empty())
     statement.BindString(column++, filter.id);
@@ -514,7 +646,7 @@ void PublisherInfoDatabase::BindFilter(sql::Statement& statement,
   if (filter.year > 0)
     statement.BindInt(column++, filter.year);
 
-   if (filter.reconcile_stamp > 0)
+  if (filter.reconcile_stamp > 0)
     statement.BindInt64(column++, filter.reconcile_stamp);
 
   if (filter.min_duration > 0)
@@ -528,6 +660,22 @@ void PublisherInfoDatabase::BindFilter(sql::Statement& statement,
   if (filter.excluded ==
     ledger::PUBLISHER_EXCLUDE_FILTER::FILTER_ALL_EXCEPT_EXCLUDED)
     statement.BindInt(column++, ledger::PUBLISHER_EXCLUDE::EXCLUDED);
+
+  return column;
+}
+
+// static
+bool PublisherInfoDatabase::IsSameFilter(
+    const ledger::PublisherInfoFilter& left,
+    const ledger::PublisherInfoFilter& right) {
+  return left.id == right.id &&
+      left.category == right.category &&
+      left.month == right.month &&
+      left.year == right.year &&
+      left.reconcile_stamp == right.reconcile_stamp &&
+      left.min_duration == right.min_duration &&
+      left.excluded == right.excluded &&
+      left.order_by == right.order_by;
 }
 
 bool PublisherInfoDatabase::InsertContributionInfo(const brave_rewards::ContributionInfo& info) {
@@ -751,6 +899,23 @@ bool PublisherInfoDatabase::MigrateV1toV2() {
   return CreateRecurringDonationIndex();
 }
 
+bool PublisherInfoDatabase::MigrateV2toV3() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  // Activity rows used to be matched with a SELECT before inserting, so
+  // there should be no duplicates, but the unique index can't be created
+  // if there are. Duplicates were always updated together, so any of them
+  // can be kept.
+  if (!GetDB().Execute(
+      "DELETE FROM activity_info WHERE rowid NOT IN "
+      "(SELECT MAX(rowid) FROM activity_info "
+      "GROUP BY publisher_id, category, month, year, reconcile_stamp)")) {
+    return false;
+  }
+
+  return CreateActivityInfoUniqueIndex();
+}
+
 sql::InitStatus PublisherInfoDatabase::EnsureCurrentVersion() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
@@ -764,14 +929,22 @@ sql::InitStatus PublisherInfoDatabase::EnsureCurrentVersion() {
   const int cur_version = GetCurrentVersion();
 
   // Migration from version 1 to version 2
-  if (old_version == 1 && cur_version == 2) {
+  if (old_version < 2 && cur_version >= 2) {
     if (!MigrateV1toV2()) {
       LOG(ERROR) << "DB: Error with MigrateV1toV2";
     }
+  }
 
-    meta_table_.SetVersionNumber(cur_version);
+  // Migration from version 2 to version 3
+  if (old_version < 3 && cur_version >= 3) {
+    if (!MigrateV2toV3()) {
+      LOG(ERROR) << "DB: Error with MigrateV2toV3";
+    }
   }
 
+  if (old_version < cur_version)
+    meta_table_.SetVersionNumber(cur_version);
+
   return sql::INIT_OK;
 }
 
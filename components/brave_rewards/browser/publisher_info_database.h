@@ -6,12 +6,17 @@
 #define BRAVE_COMPONENTS_BRAVE_REWARDS_PUBLISHER_INFO_DATABASE_H_
 
 #include <memory>
+#include <set>
 #include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 #include "base/compiler_specific.h"
 #include "base/files/file_path.h"
 #include "base/macros.h"
 #include "base/memory/memory_pressure_listener.h"
+#include "base/optional.h"
 #include "base/sequence_checker.h"
 #include "bat/ledger/publisher_info.h"
 #include "brave/components/brave_rewards/browser/contribution_info.h"
@@ -35,6 +40,9 @@ class PublisherInfoDatabase {
   }
 
   bool InsertOrUpdatePublisherInfo(const ledger::PublisherInfo& info);
+  // Saves all of |list| in one transaction. Returns false, without saving
+  // any of them, if one fails.
+  bool InsertOrUpdatePublisherInfoList(const ledger::PublisherInfoList& list);
   bool InsertOrUpdateMediaPublisherInfo(const std::string& media_key, const std::string& publisher_id);
   bool InsertContributionInfo(const brave_rewards::ContributionInfo& info);
   bool InsertOrUpdateRecurringDonation(const brave_rewards::RecurringDonation& info);
@@ -43,7 +51,17 @@ class PublisherInfoDatabase {
             int limit,
             const ledger::PublisherInfoFilter& filter,
             ledger::PublisherInfoList* list);
+  // Like Find(), also appending the activity_info rowid of each row to
+  // |rowids|.
+  bool Find(int start,
+            int limit,
+            const ledger::PublisherInfoFilter& filter,
+            ledger::PublisherInfoList* list,
+            std::vector<int64_t>* rowids);
   int Count(const ledger::PublisherInfoFilter& filter);
+  // Returns the rowid of the activity_info row of |info|, or 0 if there is
+  // none.
+  int64_t GetActivityInfoRowId(const ledger::PublisherInfo& info);
 
   std::unique_ptr<ledger::PublisherInfo> GetMediaPublisherInfo(
       const std::string& media_key);
@@ -70,26 +88,47 @@ class PublisherInfoDatabase {
   bool CreateActivityInfoTable();
   bool CreateContributionInfoIndex();
   bool CreateActivityInfoIndex();
+  bool CreateActivityInfoUniqueIndex();
+  bool CreateActivityInfoFilterIndexes();
   bool CreateRecurringDonationTable();
   bool CreateRecurringDonationIndex();
 
-  std::string BuildClauses(int start,
-                           int limit,
-                           const ledger::PublisherInfoFilter& filter);
-  void BindFilter(sql::Statement& statement,
-                  const ledger::PublisherInfoFilter& filter);
+  scoped_refptr<sql::Database::StatementRef> GetCachedQueryStatement(
+      const std::string& query);
+  std::string BuildClauses(const ledger::PublisherInfoFilter& filter);
+  std::string BuildOrderBy(const ledger::PublisherInfoFilter& filter);
+  // Returns the index of the first parameter after the filter's.
+  int BindFilter(sql::Statement& statement,
+                 const ledger::PublisherInfoFilter& filter);
+  static bool IsSameFilter(const ledger::PublisherInfoFilter& left,
+                           const ledger::PublisherInfoFilter& right);
 
   sql::Database& GetDB();
   sql::MetaTable& GetMetaTable();
 
   sql::InitStatus EnsureCurrentVersion();
   bool MigrateV1toV2();
+  bool MigrateV2toV3();
+
+  bool UpsertPublisherInfo(const ledger::PublisherInfo& info);
 
   sql::Database db_;
   sql::MetaTable meta_table_;
   const base::FilePath db_path_;
   bool initialized_;
 
+  // Where the last page returned by Find() ended, so that the next page can
+  // continue from there
+  struct FindCursor {
+    ledger::PublisherInfoFilter filter;
+    int next_start;
+    double sort_key;
+    int64_t rowid;
+  };
+  base::Optional<FindCursor> find_cursor_;
+  // Query text of the cached statements used by Find() and Count()
+  std::set<std::string> cached_queries_;
+
   std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
 
   SEQUENCE_CHECKER(sequence_checker_);
@@ -0,0 +1,141 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_rewards/browser/publisher_info_database.h"
+
+#include <string>
+#include <utility>
+
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=PublisherInfoDatabaseTest.*
+
+namespace brave_rewards {
+
+class PublisherInfoDatabaseTest : public testing::Test {
+ public:
+  PublisherInfoDatabaseTest() {}
+  ~PublisherInfoDatabaseTest() override {}
+
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    database_.reset(new PublisherInfoDatabase(
+        temp_dir_.GetPath().AppendASCII("publisher_info_db")));
+  }
+
+  // Adds |count| auto contribute publishers with distinct durations and
+  // percents descending in steps of |count| / 100, so percents repeat.
+  void AddPublishers(int count) {
+    ledger::PublisherInfoList list;
+    for (int i = 0; i < count; ++i) {
+      ledger::PublisherInfo info("publisher" + base::IntToString(i),
+                                 ledger::PUBLISHER_MONTH::JANUARY, 2019);
+      info.category = ledger::PUBLISHER_CATEGORY::AUTO_CONTRIBUTE;
+      info.reconcile_stamp = 1;
+      info.duration = 100 + i;
+      info.percent = 100 - i * 100 / count;
+      info.name = info.id;
+      list.push_back(info);
+    }
+    ASSERT_TRUE(database_->InsertOrUpdatePublisherInfoList(list));
+  }
+
+  ledger::PublisherInfoFilter ContributeFilter() {
+    ledger::PublisherInfoFilter filter;
+    filter.category = ledger::PUBLISHER_CATEGORY::AUTO_CONTRIBUTE;
+    filter.month = ledger::PUBLISHER_MONTH::ANY;
+    filter.year = -1;
+    filter.reconcile_stamp = 1;
+    filter.min_duration = 100;
+    filter.excluded =
+        ledger::PUBLISHER_EXCLUDE_FILTER::FILTER_ALL_EXCEPT_EXCLUDED;
+    filter.order_by.push_back(std::make_pair("ai.percent", false));
+    return filter;
+  }
+
+  base::ScopedTempDir temp_dir_;
+  std::unique_ptr<PublisherInfoDatabase> database_;
+};
+
+TEST_F(PublisherInfoDatabaseTest, InsertOrUpdatePublisherInfoList) {
+  AddPublishers(10);
+
+  ledger::PublisherInfo info("publisher3", ledger::PUBLISHER_MONTH::JANUARY,
+                             2019);
+  info.category = ledger::PUBLISHER_CATEGORY::AUTO_CONTRIBUTE;
+  info.reconcile_stamp = 1;
+  info.duration = 1000;
+  ASSERT_TRUE(database_->InsertOrUpdatePublisherInfo(info));
+
+  ledger::PublisherInfoFilter filter = ContributeFilter();
+  EXPECT_EQ(database_->Count(filter), 10);
+
+  filter.id = "publisher3";
+  ledger::PublisherInfoList list;
+  ASSERT_TRUE(database_->Find(0, 0, filter, &list));
+  ASSERT_EQ(list.size(), 1u);
+  EXPECT_EQ(list[0].duration, 1000u);
+}
+
+TEST_F(PublisherInfoDatabaseTest, FindPages) {
+  // Consecutive pages seek from the end of the previous one, and must
+  // match pages read with an offset
+  AddPublishers(1000);
+  const ledger::PublisherInfoFilter filter = ContributeFilter();
+
+  ledger::PublisherInfoList all;
+  ASSERT_TRUE(database_->Find(0, 0, filter, &all));
+  ASSERT_EQ(all.size(), 1000u);
+
+  ledger::PublisherInfoList pages;
+  for (int start = 0; start < 1000; start += 64)
+    ASSERT_TRUE(database_->Find(start, 64, filter, &pages));
+  ASSERT_EQ(pages.size(), all.size());
+  for (size_t i = 0; i < all.size(); ++i)
+    EXPECT_EQ(pages[i].id, all[i].id);
+
+  // a page that doesn't follow the previous one
+  ledger::PublisherInfoList page;
+  ASSERT_TRUE(database_->Find(500, 10, filter, &page));
+  ASSERT_EQ(page.size(), 10u);
+  EXPECT_EQ(page[0].id, all[500].id);
+}
+
+TEST_F(PublisherInfoDatabaseTest, FindPageStarts) {
+  // A start of 1 reads from the first row, like a start of 0
+  AddPublishers(100);
+  const ledger::PublisherInfoFilter filter = ContributeFilter();
+
+  ledger::PublisherInfoList all;
+  ASSERT_TRUE(database_->Find(0, 0, filter, &all));
+  ASSERT_EQ(all.size(), 100u);
+
+  ledger::PublisherInfoList page;
+  ASSERT_TRUE(database_->Find(0, 1, filter, &page));
+  ASSERT_TRUE(database_->Find(1, 1, filter, &page));
+  ASSERT_TRUE(database_->Find(1, 10, filter, &page));
+  ASSERT_EQ(page.size(), 12u);
+  EXPECT_EQ(page[0].id, all[0].id);
+  EXPECT_EQ(page[1].id, all[0].id);
+  for (size_t i = 0; i < 10; ++i)
+    EXPECT_EQ(page[i + 2].id, all[i].id);
+
+  // the page after one read with a start of 1
+  page.clear();
+  ASSERT_TRUE(database_->Find(10, 10, filter, &page));
+  ASSERT_EQ(page.size(), 10u);
+  for (size_t i = 0; i < 10; ++i)
+    EXPECT_EQ(page[i].id, all[i + 10].id);
+
+  // the last, partial page
+  page.clear();
+  ASSERT_TRUE(database_->Find(95, 10, filter, &page));
+  ASSERT_EQ(page.size(), 5u);
+  EXPECT_EQ(page[4].id, all[99].id);
+}
+
+}  // namespace brave_rewards
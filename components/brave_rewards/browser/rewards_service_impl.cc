@@ -4,14 +4,13 @@
 
 #include "brave/components/brave_rewards/browser/rewards_service_impl.h"
 
+#include <algorithm>
 #include <functional>
 #include <limits.h>
 #include <vector>
 
 #include "base/bind.h"
 #include "base/command_line.h"
-#include "base/files/file_util.h"
-#include "base/files/important_file_writer.h"
 #include "base/guid.h"
 #include "base/logging.h"
 #include "base/i18n/time_formatting.h"
@@ -21,7 +20,6 @@
 #include "base/strings/utf_string_conversions.h"
 #include "base/task/post_task.h"
 #include "base/task_runner_util.h"
-#include "base/threading/sequenced_task_runner_handle.h"
 #include "bat/ledger/ledger.h"
 #include "bat/ledger/media_publisher_info.h"
 #include "bat/ledger/publisher_info.h"
@@ -30,12 +28,14 @@
 #include "brave/common/brave_switches.h"
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_rewards/browser/balance_report.h"
+#include "brave/components/brave_rewards/browser/contribute_list_index.h"
 #include "brave/components/brave_rewards/browser/publisher_info_database.h"
 #include "brave/components/brave_rewards/browser/rewards_fetcher_service_observer.h"
 #include "brave/components/brave_rewards/browser/rewards_notification_service.h"
 #include "brave/components/brave_rewards/browser/rewards_notification_service_impl.h"
 #include "brave/components/brave_rewards/browser/rewards_service_factory.h"
 #include "brave/components/brave_rewards/browser/rewards_service_observer.h"
+#include "brave/components/brave_rewards/browser/state_file_writer.h"
 #include "brave/components/brave_rewards/browser/wallet_properties.h"
 #include "chrome/browser/bitmap_fetcher/bitmap_fetcher_service_factory.h"
 #include "chrome/browser/browser_process_impl.h"
@@ -167,19 +167,6 @@ net::URLFetcher::RequestType URLMethodToRequestType(ledger::URL_METHOD method) {
   }
 }
 
-std::string LoadStateOnFileTaskRunner(
-    const base::FilePath& path) {
-  std::string data;
-  bool success = base::ReadFileToString(path, &data);
-
-  // Make sure the file isn't empty.
-  if (!success || data.empty()) {
-    LOG(ERROR) << "Failed to read file: " << path.MaybeAsASCII();
-    return std::string();
-  }
-  return data;
-}
-
 bool SaveMediaPublisherInfoOnFileTaskRunner(
     const std::string& media_key,
     const std::string& publisher_id,
@@ -202,11 +189,14 @@ LoadMediaPublisherInfoListOnFileTaskRunner(
   return info;
 }
 
-bool SavePublisherInfoOnFileTaskRunner(
-    const ledger::PublisherInfo publisher_info,
-    PublisherInfoDatabase* backend) {
-  if (backend && backend->InsertOrUpdatePublisherInfo(publisher_info))
+bool SavePublisherInfoListOnFileTaskRunner(
+    const ledger::PublisherInfoList list,
+    PublisherInfoDatabase* backend,
+    ContributeListIndex* contribute_list) {
+  if (backend && backend->InsertOrUpdatePublisherInfoList(list)) {
+    contribute_list->Update(list, backend);
     return true;
+  }
 
   return false;
 }
@@ -215,27 +205,24 @@ ledger::PublisherInfoList LoadPublisherInfoListOnFileTaskRunner(
     uint32_t start,
     uint32_t limit,
     ledger::PublisherInfoFilter filter,
-    PublisherInfoDatabase* backend) {
+    PublisherInfoDatabase* backend,
+    ContributeListIndex* contribute_list) {
   ledger::PublisherInfoList list;
   if (!backend)
     return list;
 
+  // the contribute list is read from memory, the database is only read
+  // once per reconcile period
+  if (ContributeListIndex::IsContributeListFilter(filter) &&
+      contribute_list->Load(filter.reconcile_stamp, backend)) {
+    contribute_list->Find(start, limit, filter, &list);
+    return list;
+  }
+
   ignore_result(backend->Find(start, limit, filter, &list));
   return list;
 }
 
-// `callback` has a WeakPtr so this won't crash if the file finishes
-// writing after RewardsServiceImpl has been destroyed
-void PostWriteCallback(
-    const base::Callback<void(bool success)>& callback,
-    scoped_refptr<base::SequencedTaskRunner> reply_task_runner,
-    bool write_success) {
-  // We can't run |callback| on the current thread. Bounce back to
-  // the |reply_task_runner| which is the correct sequenced thread.
-  reply_task_runner->PostTask(FROM_HERE,
-                              base::Bind(callback, write_success));
-}
-
 void GetContentSiteListInternal(
     uint32_t start,
     uint32_t limit,
@@ -280,6 +267,15 @@ const base::FilePath::StringType kPublisher_info_db("publisher_info_db");
 const base::FilePath::StringType kPublishers_list("publishers_list");
 #endif
 
+// How long publisher info saves are queued before being written together
+const int kPublisherInfoSaveDelaySeconds = 10;
+
+// How long state saves are coalesced before being written. The ledger state
+// holds the wallet, so it's kept short.
+const int kLedgerStateSaveDelaySeconds = 1;
+const int kPublisherStateSaveDelaySeconds = 10;
+const int kPublishersListSaveDelaySeconds = 10;
+
 RewardsServiceImpl::RewardsServiceImpl(Profile* profile)
     : profile_(profile),
       ledger_(ledger::Ledger::CreateInstance(this)),
@@ -294,8 +290,22 @@ RewardsServiceImpl::RewardsServiceImpl(Profile* profile)
       publisher_state_path_(profile_->GetPath().Append(kPublisher_state)),
       publisher_info_db_path_(profile->GetPath().Append(kPublisher_info_db)),
       publisher_list_path_(profile->GetPath().Append(kPublishers_list)),
+      ledger_state_writer_(new StateFileWriter(
+          ledger_state_path_, file_task_runner_,
+          base::TimeDelta::FromSeconds(kLedgerStateSaveDelaySeconds),
+          false)),
+      publisher_state_writer_(new StateFileWriter(
+          publisher_state_path_, file_task_runner_,
+          base::TimeDelta::FromSeconds(kPublisherStateSaveDelaySeconds),
+          false)),
+      // the publishers list is megabytes of JSON
+      publishers_list_writer_(new StateFileWriter(
+          publisher_list_path_, file_task_runner_,
+          base::TimeDelta::FromSeconds(kPublishersListSaveDelaySeconds),
+          true)),
       publisher_info_backend_(
           new PublisherInfoDatabase(publisher_info_db_path_)),
+      contribute_list_index_(new ContributeListIndex()),
       notification_service_(new RewardsNotificationServiceImpl(profile)),
 #if BUILDFLAG(ENABLE_EXTENSIONS)
       private_observer_(
@@ -327,6 +337,7 @@ RewardsServiceImpl::RewardsServiceImpl(Profile* profile)
 
 RewardsServiceImpl::~RewardsServiceImpl() {
   file_task_runner_->DeleteSoon(FROM_HERE, publisher_info_backend_.release());
+  file_task_runner_->DeleteSoon(FROM_HERE, contribute_list_index_.release());
 }
 
 void RewardsServiceImpl::Init() {
@@ -484,6 +495,9 @@ void RewardsServiceImpl::OnXHRLoad(SessionID tab_id,
 void RewardsServiceImpl::LoadMediaPublisherInfo(
     const std::string& media_key,
     ledger::PublisherInfoCallback callback) {
+  // the publisher the media belongs to is only known to the database, so
+  // any queued save could be the one read
+  FlushPublisherInfoSaves();
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
       base::Bind(&LoadMediaPublisherInfoListOnFileTaskRunner,
           media_key, publisher_info_backend_.get()),
@@ -555,6 +569,10 @@ void RewardsServiceImpl::Shutdown() {
   }
   fetchers_.clear();
 
+  FlushPublisherInfoSaves();
+  ledger_state_writer_->DoScheduledWrite();
+  publisher_state_writer_->DoScheduledWrite();
+  publishers_list_writer_->DoScheduledWrite();
   ledger_.reset();
   RewardsService::Shutdown();
 }
@@ -653,8 +671,10 @@ void RewardsServiceImpl::OnReconcileComplete(ledger::Result result,
 
 void RewardsServiceImpl::LoadLedgerState(
     ledger::LedgerCallbackHandler* handler) {
+  // a scheduled write goes before the read
+  ledger_state_writer_->DoScheduledWrite();
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
-      base::Bind(&LoadStateOnFileTaskRunner, ledger_state_path_),
+      base::Bind(&StateFileWriter::ReadStateFile, ledger_state_path_),
       base::Bind(&RewardsServiceImpl::OnLedgerStateLoaded,
                      AsWeakPtr(),
                      base::Unretained(handler)));
@@ -670,8 +690,9 @@ void RewardsServiceImpl::OnLedgerStateLoaded(
 
 void RewardsServiceImpl::LoadPublisherState(
     ledger::LedgerCallbackHandler* handler) {
+  publisher_state_writer_->DoScheduledWrite();
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
-      base::Bind(&LoadStateOnFileTaskRunner, publisher_state_path_),
+      base::Bind(&StateFileWriter::ReadStateFile, publisher_state_path_),
       base::Bind(&RewardsServiceImpl::OnPublisherStateLoaded,
                      AsWeakPtr(),
                      base::Unretained(handler)));
@@ -688,45 +709,35 @@ void RewardsServiceImpl::OnPublisherStateLoaded(
 
 void RewardsServiceImpl::SaveLedgerState(const std::string& ledger_state,
                                       ledger::LedgerCallbackHandler* handler) {
-  base::ImportantFileWriter writer(
-      ledger_state_path_, file_task_runner_);
-
-  writer.RegisterOnNextWriteCallbacks(
-      base::Closure(),
-      base::Bind(
-        &PostWriteCallback,
-        base::Bind(&RewardsServiceImpl::OnLedgerStateSaved, AsWeakPtr(),
-            base::Unretained(handler)),
-        base::SequencedTaskRunnerHandle::Get()));
-
-  writer.WriteNow(std::make_unique<std::string>(ledger_state));
+  ledger_state_writer_->Save(ledger_state,
+      base::Bind(&RewardsServiceImpl::OnLedgerStateSaved, AsWeakPtr(),
+                 base::Unretained(handler)));
 }
 
 void RewardsServiceImpl::OnLedgerStateSaved(
     ledger::LedgerCallbackHandler* handler,
     bool success) {
+  // the ledger is gone if the state was written on shutdown
+  if (!ledger_)
+    return;
+
   handler->OnLedgerStateSaved(success ? ledger::Result::LEDGER_OK
                                       : ledger::Result::NO_LEDGER_STATE);
 }
 
 void RewardsServiceImpl::SavePublisherState(const std::string& publisher_state,
                                       ledger::LedgerCallbackHandler* handler) {
-  base::ImportantFileWriter writer(publisher_state_path_, file_task_runner_);
-
-  writer.RegisterOnNextWriteCallbacks(
-      base::Closure(),
-      base::Bind(
-        &PostWriteCallback,
-        base::Bind(&RewardsServiceImpl::OnPublisherStateSaved, AsWeakPtr(),
-            base::Unretained(handler)),
-        base::SequencedTaskRunnerHandle::Get()));
-
-  writer.WriteNow(std::make_unique<std::string>(publisher_state));
+  publisher_state_writer_->Save(publisher_state,
+      base::Bind(&RewardsServiceImpl::OnPublisherStateSaved, AsWeakPtr(),
+                 base::Unretained(handler)));
 }
 
 void RewardsServiceImpl::OnPublisherStateSaved(
     ledger::LedgerCallbackHandler* handler,
     bool success) {
+  if (!ledger_)
+    return;
+
   handler->OnPublisherStateSaved(success ? ledger::Result::LEDGER_OK
                                          : ledger::Result::LEDGER_ERROR);
 }
@@ -747,24 +758,67 @@ void RewardsServiceImpl::LoadNicewareList(
 void RewardsServiceImpl::SavePublisherInfo(
     std::unique_ptr<ledger::PublisherInfo> publisher_info,
     ledger::PublisherInfoCallback callback) {
-  ledger::PublisherInfo info_copy = *publisher_info;
+  // Saves are written in batches, one transaction each, so that browsing
+  // doesn't cause a steady stream of small writes
+  publisher_info_saves_.push_back(
+      std::make_pair(std::move(publisher_info), callback));
+  if (!publisher_info_save_timer_.IsRunning()) {
+    publisher_info_save_timer_.Start(FROM_HERE,
+        base::TimeDelta::FromSeconds(kPublisherInfoSaveDelaySeconds),
+        base::Bind(&RewardsServiceImpl::FlushPublisherInfoSaves,
+                   AsWeakPtr()));
+  }
+}
+
+void RewardsServiceImpl::FlushPublisherInfoSaves() {
+  publisher_info_save_timer_.Stop();
+  if (publisher_info_saves_.empty())
+    return;
+
+  ledger::PublisherInfoList list;
+  list.reserve(publisher_info_saves_.size());
+  for (const auto& save : publisher_info_saves_)
+    list.push_back(*save.first);
+
+  PublisherInfoSaves saves;
+  saves.swap(publisher_info_saves_);
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
-      base::Bind(&SavePublisherInfoOnFileTaskRunner,
-                    info_copy,
-                    publisher_info_backend_.get()),
-      base::Bind(&RewardsServiceImpl::OnPublisherInfoSaved,
+      base::Bind(&SavePublisherInfoListOnFileTaskRunner,
+                    list,
+                    publisher_info_backend_.get(),
+                    contribute_list_index_.get()),
+      base::Bind(&RewardsServiceImpl::OnPublisherInfoListSaved,
                      AsWeakPtr(),
-                     callback,
-                     base::Passed(std::move(publisher_info))));
+                     base::Passed(std::move(saves))));
+}
+
+void RewardsServiceImpl::FlushPublisherInfoSavesFor(
+    const ledger::PublisherInfoFilter& filter) {
+  // a read of one publisher only sees that publisher's saves
+  if (!filter.id.empty()) {
+    auto it = std::find_if(publisher_info_saves_.begin(),
+                           publisher_info_saves_.end(),
+        [&filter](const PublisherInfoSaves::value_type& save) {
+          return save.first->id == filter.id;
+        });
+    if (it == publisher_info_saves_.end())
+      return;
+  }
 
+  FlushPublisherInfoSaves();
 }
 
-void RewardsServiceImpl::OnPublisherInfoSaved(
-    ledger::PublisherInfoCallback callback,
-    std::unique_ptr<ledger::PublisherInfo> info,
+void RewardsServiceImpl::OnPublisherInfoListSaved(
+    PublisherInfoSaves saves,
     bool success) {
-  callback(success ? ledger::Result::LEDGER_OK
-                   : ledger::Result::LEDGER_ERROR, std::move(info));
+  // the ledger is gone if the saves were flushed on shutdown
+  if (!ledger_)
+    return;
+
+  for (auto& save : saves) {
+    save.second(success ? ledger::Result::LEDGER_OK
+                        : ledger::Result::LEDGER_ERROR, std::move(save.first));
+  }
 
   TriggerOnContentSiteUpdated();
 }
@@ -772,11 +826,13 @@ void RewardsServiceImpl::OnPublisherInfoSaved(
 void RewardsServiceImpl::LoadPublisherInfo(
     ledger::PublisherInfoFilter filter,
     ledger::PublisherInfoCallback callback) {
+  FlushPublisherInfoSavesFor(filter);
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
       base::Bind(&LoadPublisherInfoListOnFileTaskRunner,
           // set limit to 2 to make sure there is
           // only 1 valid result for the filter
-          0, 2, filter, publisher_info_backend_.get()),
+          0, 2, filter, publisher_info_backend_.get(),
+          contribute_list_index_.get()),
       base::Bind(&RewardsServiceImpl::OnPublisherInfoLoaded,
                      AsWeakPtr(),
                      callback));
@@ -804,10 +860,12 @@ void RewardsServiceImpl::LoadPublisherInfoList(
     uint32_t limit,
     ledger::PublisherInfoFilter filter,
     ledger::PublisherInfoListCallback callback) {
+  FlushPublisherInfoSavesFor(filter);
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
       base::Bind(&LoadPublisherInfoListOnFileTaskRunner,
                     start, limit, filter,
-                    publisher_info_backend_.get()),
+                    publisher_info_backend_.get(),
+                    contribute_list_index_.get()),
       base::Bind(&RewardsServiceImpl::OnPublisherInfoListLoaded,
                     AsWeakPtr(),
                     start,
@@ -820,10 +878,12 @@ void RewardsServiceImpl::LoadCurrentPublisherInfoList(
     uint32_t limit,
     ledger::PublisherInfoFilter filter,
     ledger::PublisherInfoListCallback callback) {
+  FlushPublisherInfoSavesFor(filter);
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
       base::Bind(&LoadPublisherInfoListOnFileTaskRunner,
                     start, limit, filter,
-                    publisher_info_backend_.get()),
+                    publisher_info_backend_.get(),
+                    contribute_list_index_.get()),
       base::Bind(&RewardsServiceImpl::OnPublisherInfoListLoaded,
                     AsWeakPtr(),
                     start,
@@ -1158,23 +1218,17 @@ void RewardsServiceImpl::TriggerOnContentSiteUpdated() {
 
 void RewardsServiceImpl::SavePublishersList(const std::string& publishers_list,
                                       ledger::LedgerCallbackHandler* handler) {
-  base::ImportantFileWriter writer(
-      publisher_list_path_, file_task_runner_);
-
-  writer.RegisterOnNextWriteCallbacks(
-      base::Closure(),
-      base::Bind(
-        &PostWriteCallback,
-        base::Bind(&RewardsServiceImpl::OnPublishersListSaved, AsWeakPtr(),
-            base::Unretained(handler)),
-        base::SequencedTaskRunnerHandle::Get()));
-
-  writer.WriteNow(std::make_unique<std::string>(publishers_list));
+  publishers_list_writer_->Save(publishers_list,
+      base::Bind(&RewardsServiceImpl::OnPublishersListSaved, AsWeakPtr(),
+                 base::Unretained(handler)));
 }
 
 void RewardsServiceImpl::OnPublishersListSaved(
     ledger::LedgerCallbackHandler* handler,
     bool success) {
+  if (!ledger_)
+    return;
+
   handler->OnPublishersListSaved(success ? ledger::Result::LEDGER_OK
                                          : ledger::Result::LEDGER_ERROR);
 }
@@ -1202,8 +1256,9 @@ void RewardsServiceImpl::OnTimer(uint32_t timer_id) {
 
 void RewardsServiceImpl::LoadPublisherList(
     ledger::LedgerCallbackHandler* handler) {
+  publishers_list_writer_->DoScheduledWrite();
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
-                                   base::Bind(&LoadStateOnFileTaskRunner, publisher_list_path_),
+                                   base::Bind(&StateFileWriter::ReadStateFile, publisher_list_path_),
                                    base::Bind(&RewardsServiceImpl::OnPublisherListLoaded,
                                               AsWeakPtr(),
                                               base::Unretained(handler)));
@@ -1462,7 +1517,6 @@ void RewardsServiceImpl::SaveContributionInfo(const std::string& probi,
   const uint32_t date,
   const std::string& publisher_key,
   const ledger::PUBLISHER_CATEGORY category) {
-
   brave_rewards::ContributionInfo info;
   info.probi = probi;
   info.month = month;
@@ -1526,6 +1580,7 @@ void RewardsServiceImpl::OnRecurringDonationsData(const ledger::PublisherInfoLis
 }
 
 void RewardsServiceImpl::GetRecurringDonations(ledger::PublisherInfoListCallback callback) {
+  FlushPublisherInfoSaves();
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
       base::Bind(&GetRecurringDonationsOnFileTaskRunner,
                     publisher_info_backend_.get()),
@@ -1588,6 +1643,7 @@ void RewardsServiceImpl::RemoveRecurring(const std::string& publisher_key) {
 }
 
 void RewardsServiceImpl::TipsUpdated() {
+  FlushPublisherInfoSaves();
   base::PostTaskAndReplyWithResult(file_task_runner_.get(), FROM_HERE,
       base::Bind(&TipsUpdatedOnFileTaskRunner,
                     publisher_info_backend_.get()),
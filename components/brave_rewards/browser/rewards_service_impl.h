@@ -9,6 +9,8 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "bat/ledger/ledger.h"
 #include "bat/ledger/wallet_info.h"
@@ -56,8 +58,10 @@ class Profile;
 
 namespace brave_rewards {
 
+class ContributeListIndex;
 class PublisherInfoDatabase;
 class RewardsNotificationService;
+class StateFileWriter;
 
 class RewardsServiceImpl : public RewardsService,
                             public ledger::LedgerClient,
@@ -160,9 +164,13 @@ class RewardsServiceImpl : public RewardsService,
                               double balance,
                               const std::vector<ledger::Grant>& grants);
   void TriggerOnGrantFinish(ledger::Result result, const ledger::Grant& grant);
-  void OnPublisherInfoSaved(ledger::PublisherInfoCallback callback,
-                            std::unique_ptr<ledger::PublisherInfo> info,
-                            bool success);
+  using PublisherInfoSaves =
+      std::vector<std::pair<std::unique_ptr<ledger::PublisherInfo>,
+                            ledger::PublisherInfoCallback>>;
+  void FlushPublisherInfoSaves();
+  // Flushes the queued saves if a read with |filter| could return them.
+  void FlushPublisherInfoSavesFor(const ledger::PublisherInfoFilter& filter);
+  void OnPublisherInfoListSaved(PublisherInfoSaves saves, bool success);
   void OnPublisherInfoLoaded(ledger::PublisherInfoCallback callback,
                              const ledger::PublisherInfoList list);
   void OnMediaPublisherInfoSaved(bool success);
@@ -298,7 +306,12 @@ class RewardsServiceImpl : public RewardsService,
   const base::FilePath publisher_state_path_;
   const base::FilePath publisher_info_db_path_;
   const base::FilePath publisher_list_path_;
+  std::unique_ptr<StateFileWriter> ledger_state_writer_;
+  std::unique_ptr<StateFileWriter> publisher_state_writer_;
+  std::unique_ptr<StateFileWriter> publishers_list_writer_;
   std::unique_ptr<PublisherInfoDatabase> publisher_info_backend_;
+  // Used on |file_task_runner_|, like |publisher_info_backend_|
+  std::unique_ptr<ContributeListIndex> contribute_list_index_;
   std::unique_ptr<RewardsNotificationService> notification_service_;
   base::ObserverList<RewardsServicePrivateObserver> private_observers_;
 #if BUILDFLAG(ENABLE_EXTENSIONS)
@@ -308,6 +321,9 @@ class RewardsServiceImpl : public RewardsService,
   extensions::OneShotEvent ready_;
   std::map<const net::URLFetcher*, FetchCallback> fetchers_;
   std::map<uint32_t, std::unique_ptr<base::OneShotTimer>> timers_;
+  // SavePublisherInfo() calls not yet written to the database
+  PublisherInfoSaves publisher_info_saves_;
+  base::OneShotTimer publisher_info_save_timer_;
   std::vector<std::string> current_media_fetchers_;
   std::vector<BitmapFetcherService::RequestId> request_ids_;
 
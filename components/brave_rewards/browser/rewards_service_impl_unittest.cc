@@ -3,6 +3,9 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include <map>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "base/files/scoped_temp_dir.h"
 #include "brave/components/brave_rewards/browser/wallet_properties.h"
@@ -12,6 +15,7 @@
 #include "brave/components/brave_rewards/browser/test_util.h"
 #include "chrome/browser/profiles/profile.h"
 #include "content/public/test/test_browser_thread_bundle.h"
+#include "content/public/test/test_utils.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -162,4 +166,34 @@ TEST_F(RewardsServiceTest, OnWalletProperties) {
   EXPECT_CALL(*observer(), OnWalletProperties(_, _, _)).Times(0);
 }
 
+TEST_F(RewardsServiceTest, BatchesPublisherInfoSaves) {
+  ledger::LedgerClient* client = rewards_service();
+  std::vector<std::string> saved;
+  auto on_saved = [&saved](ledger::Result result,
+                           std::unique_ptr<ledger::PublisherInfo> info) {
+    EXPECT_EQ(result, ledger::Result::LEDGER_OK);
+    saved.push_back(info->id);
+  };
+  for (const char* id : {"brave.com", "github.com", "example.com"}) {
+    client->SavePublisherInfo(std::make_unique<ledger::PublisherInfo>(
+        id, ledger::PUBLISHER_MONTH::JANUARY, 2019), on_saved);
+  }
+
+  // reading a publisher without queued saves leaves them queued
+  auto on_loaded = [](ledger::Result result,
+                      std::unique_ptr<ledger::PublisherInfo> info) {};
+  ledger::PublisherInfoFilter filter;
+  filter.id = "brave.org";
+  client->LoadPublisherInfo(filter, on_loaded);
+  content::RunAllTasksUntilIdle();
+  EXPECT_TRUE(saved.empty());
+
+  // reading one of them writes all of them, in one batch
+  filter.id = "github.com";
+  client->LoadPublisherInfo(filter, on_loaded);
+  content::RunAllTasksUntilIdle();
+  EXPECT_EQ(saved, std::vector<std::string>(
+      {"brave.com", "github.com", "example.com"}));
+}
+
 // add test for strange entries
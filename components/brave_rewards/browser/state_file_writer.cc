@@ -0,0 +1,133 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_rewards/browser/state_file_writer.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/sequenced_task_runner.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "third_party/zlib/google/compression_utils.h"
+
+namespace brave_rewards {
+
+namespace {
+
+// JSON never starts with the gzip magic number
+bool IsGzipped(const std::string& data) {
+  return data.size() >= 2 && data[0] == '\x1f' && data[1] == '\x8b';
+}
+
+void PostWriteCallback(
+    const base::Callback<void(bool success)>& callback,
+    scoped_refptr<base::SequencedTaskRunner> reply_task_runner,
+    bool write_success) {
+  reply_task_runner->PostTask(FROM_HERE,
+                              base::Bind(callback, write_success));
+}
+
+}  // namespace
+
+StateFileWriter::StateFileWriter(
+    const base::FilePath& path,
+    scoped_refptr<base::SequencedTaskRunner> task_runner,
+    base::TimeDelta interval,
+    bool compress)
+    : writer_(path, task_runner, interval),
+      compress_(compress),
+      data_written_(false),
+      weak_factory_(this) {
+}
+
+StateFileWriter::~StateFileWriter() {
+  DoScheduledWrite();
+}
+
+// static
+std::string StateFileWriter::ReadStateFile(const base::FilePath& path) {
+  std::string data;
+  bool success = base::ReadFileToString(path, &data);
+
+  // Make sure the file isn't empty.
+  if (!success || data.empty()) {
+    LOG(ERROR) << "Failed to read file: " << path.MaybeAsASCII();
+    return std::string();
+  }
+
+  if (!IsGzipped(data))
+    return data;
+
+  std::string uncompressed;
+  if (!compression::GzipUncompress(data, &uncompressed)) {
+    LOG(ERROR) << "Failed to uncompress file: " << path.MaybeAsASCII();
+    return std::string();
+  }
+  return uncompressed;
+}
+
+void StateFileWriter::Save(const std::string& data, SavedCallback callback) {
+  if (data == data_) {
+    // already on its way to disk, or there
+    if (writer_.HasPendingWrite()) {
+      scheduled_callbacks_.push_back(callback);
+      return;
+    }
+    if (!writing_callbacks_.empty()) {
+      writing_callbacks_.back().push_back(callback);
+      return;
+    }
+    if (data_written_) {
+      base::SequencedTaskRunnerHandle::Get()->PostTask(FROM_HERE,
+          base::Bind(callback, true));
+      return;
+    }
+  }
+
+  data_ = data;
+  data_written_ = false;
+  scheduled_callbacks_.push_back(callback);
+  writer_.ScheduleWrite(this);
+}
+
+void StateFileWriter::DoScheduledWrite() {
+  if (writer_.HasPendingWrite())
+    writer_.DoScheduledWrite();
+}
+
+bool StateFileWriter::SerializeData(std::string* output) {
+  // called by |writer_| right before it writes |output|, so the callbacks
+  // registered here are those of that write
+  writing_callbacks_.push_back(std::move(scheduled_callbacks_));
+  scheduled_callbacks_.clear();
+  writer_.RegisterOnNextWriteCallbacks(
+      base::Closure(),
+      base::Bind(
+          &PostWriteCallback,
+          base::Bind(&StateFileWriter::OnWritten,
+                     weak_factory_.GetWeakPtr()),
+          base::SequencedTaskRunnerHandle::Get()));
+
+  // a failed compression still writes the state, uncompressed
+  if (!compress_ || !compression::GzipCompress(data_, output))
+    *output = data_;
+  return true;
+}
+
+void StateFileWriter::OnWritten(bool success) {
+  DCHECK(!writing_callbacks_.empty());
+  std::vector<SavedCallback> callbacks = std::move(writing_callbacks_.front());
+  writing_callbacks_.pop_front();
+
+  // |data_| is on disk if this was the last write and nothing changed since
+  if (writing_callbacks_.empty() && !writer_.HasPendingWrite())
+    data_written_ = success;
+
+  for (const auto& callback : callbacks)
+    callback.Run(success);
+}
+
+}  // namespace brave_rewards
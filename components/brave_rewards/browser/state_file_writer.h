@@ -0,0 +1,77 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_STATE_FILE_WRITER_H_
+#define BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_STATE_FILE_WRITER_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+
+namespace base {
+class SequencedTaskRunner;
+}  // namespace base
+
+namespace brave_rewards {
+
+// Persists one of the ledger's state files. Saves are coalesced: a save
+// schedules a write of the latest state after |interval|, and a state that
+// is already on disk isn't written again. Every save is acknowledged once
+// the state it asked for has been written, or has failed to.
+//
+// The state can be gzip compressed on disk, which ReadStateFile() undoes.
+class StateFileWriter
+    : public base::ImportantFileWriter::DataSerializer {
+ public:
+  using SavedCallback = base::Callback<void(bool success)>;
+
+  StateFileWriter(const base::FilePath& path,
+                  scoped_refptr<base::SequencedTaskRunner> task_runner,
+                  base::TimeDelta interval,
+                  bool compress);
+  ~StateFileWriter() override;
+
+  // Reads a state file written by a StateFileWriter, compressed or not.
+  // Returns an empty string if it can't be read. Must be called on a
+  // sequence that allows blocking.
+  static std::string ReadStateFile(const base::FilePath& path);
+
+  void Save(const std::string& data, SavedCallback callback);
+
+  // Writes a scheduled state now, e.g. on shutdown.
+  void DoScheduledWrite();
+
+  // base::ImportantFileWriter::DataSerializer:
+  bool SerializeData(std::string* output) override;
+
+ private:
+  void OnWritten(bool success);
+
+  base::ImportantFileWriter writer_;
+  const bool compress_;
+  // The latest saved state
+  std::string data_;
+  // Whether |data_| is known to be on disk
+  bool data_written_;
+  // Acknowledgements for the scheduled write, and for each write that has
+  // been started but hasn't finished, oldest first
+  std::vector<SavedCallback> scheduled_callbacks_;
+  std::deque<std::vector<SavedCallback>> writing_callbacks_;
+
+  base::WeakPtrFactory<StateFileWriter> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(StateFileWriter);
+};
+
+}  // namespace brave_rewards
+
+#endif  // BRAVE_COMPONENTS_BRAVE_REWARDS_BROWSER_STATE_FILE_WRITER_H_
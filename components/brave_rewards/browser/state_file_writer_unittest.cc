@@ -0,0 +1,119 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_rewards/browser/state_file_writer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// npm run test -- brave_unit_tests --filter=StateFileWriterTest.*
+
+namespace brave_rewards {
+
+namespace {
+
+void OnSaved(std::vector<bool>* results, bool success) {
+  results->push_back(success);
+}
+
+}  // namespace
+
+class StateFileWriterTest : public testing::Test {
+ public:
+  StateFileWriterTest() {}
+  ~StateFileWriterTest() override {}
+
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("state");
+  }
+
+  std::unique_ptr<StateFileWriter> CreateWriter(bool compress) {
+    return std::make_unique<StateFileWriter>(
+        path_, base::ThreadTaskRunnerHandle::Get(),
+        base::TimeDelta::FromHours(1), compress);
+  }
+
+  void Save(StateFileWriter* writer, const std::string& data) {
+    writer->Save(data, base::Bind(&OnSaved, &results_));
+  }
+
+  std::string ReadFile() {
+    std::string data;
+    base::ReadFileToString(path_, &data);
+    return data;
+  }
+
+  base::test::ScopedTaskEnvironment scoped_task_environment_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+  std::vector<bool> results_;
+};
+
+TEST_F(StateFileWriterTest, CoalescesSaves) {
+  std::unique_ptr<StateFileWriter> writer = CreateWriter(false);
+  Save(writer.get(), "{\"a\":1}");
+  Save(writer.get(), "{\"a\":2}");
+  scoped_task_environment_.RunUntilIdle();
+  EXPECT_TRUE(results_.empty());
+  EXPECT_FALSE(base::PathExists(path_));
+
+  writer->DoScheduledWrite();
+  scoped_task_environment_.RunUntilIdle();
+  EXPECT_EQ(results_, std::vector<bool>({true, true}));
+  EXPECT_EQ(ReadFile(), "{\"a\":2}");
+}
+
+TEST_F(StateFileWriterTest, SkipsUnchangedState) {
+  std::unique_ptr<StateFileWriter> writer = CreateWriter(false);
+  Save(writer.get(), "{\"a\":1}");
+  writer->DoScheduledWrite();
+  scoped_task_environment_.RunUntilIdle();
+  ASSERT_EQ(results_.size(), 1u);
+
+  // the state isn't written again, and the save is still acknowledged
+  ASSERT_TRUE(base::DeleteFile(path_, false));
+  Save(writer.get(), "{\"a\":1}");
+  writer->DoScheduledWrite();
+  scoped_task_environment_.RunUntilIdle();
+  EXPECT_EQ(results_, std::vector<bool>({true, true}));
+  EXPECT_FALSE(base::PathExists(path_));
+
+  Save(writer.get(), "{\"a\":2}");
+  writer->DoScheduledWrite();
+  scoped_task_environment_.RunUntilIdle();
+  EXPECT_EQ(results_.size(), 3u);
+  EXPECT_EQ(ReadFile(), "{\"a\":2}");
+}
+
+TEST_F(StateFileWriterTest, Compresses) {
+  std::string data;
+  for (int i = 0; i < 1000; ++i)
+    data += "[\"publisher.com\",true,false],";
+
+  std::unique_ptr<StateFileWriter> writer = CreateWriter(true);
+  Save(writer.get(), data);
+  writer->DoScheduledWrite();
+  scoped_task_environment_.RunUntilIdle();
+  EXPECT_EQ(results_, std::vector<bool>({true}));
+
+  EXPECT_LT(ReadFile().size(), data.size() / 10);
+  EXPECT_EQ(StateFileWriter::ReadStateFile(path_), data);
+
+  // files written before compression was enabled still read
+  ASSERT_EQ(base::WriteFile(path_, data.data(), data.size()),
+            static_cast<int>(data.size()));
+  EXPECT_EQ(StateFileWriter::ReadStateFile(path_), data);
+}
+
+}  // namespace brave_rewards
@@ -95,10 +95,7 @@ FilterOption ResourceTypeToFilterOption(content::ResourceType resource_type) {
 namespace brave_shields {
 
 AdBlockBaseService::AdBlockBaseService()
-    : BaseBraveShieldsService(),
-      ad_block_client_(new AdBlockClient()),
-      weak_factory_(this) {
-  DETACH_FROM_SEQUENCE(sequence_checker_);
+    : BaseBraveShieldsService() {
 }
 
 AdBlockBaseService::~AdBlockBaseService() {
@@ -106,45 +103,81 @@ AdBlockBaseService::~AdBlockBaseService() {
 }
 
 void AdBlockBaseService::Cleanup() {
-  ad_block_client_.reset();
+  base::AutoLock lock(engine_lock_);
+  lists_.clear();
+  engines_ = nullptr;
 }
 
 bool AdBlockBaseService::ShouldStartRequest(const GURL& url,
     content::ResourceType resource_type,
-    const std::string& tab_host) {
-  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  FilterOption current_option = ResourceTypeToFilterOption(resource_type);
-  if (ad_block_client_->matches(url.spec().c_str(),
-        current_option,
-        tab_host.c_str())) {
-    // LOG(ERROR) << "AdBlockBaseService::ShouldStartRequest(), host: " << tab_host
-    //  << ", resource type: " << resource_type
-    //  << ", url.spec(): " << url.spec();
-    return false;
+    const std::string& tab_host,
+    size_t shard) {
+  scoped_refptr<EngineList> engines = GetEngines();
+  if (!engines) {
+    return true;
+  }
+
+  // The request is converted once and then matched against every list.
+  const std::string& spec = url.spec();
+  const FilterOption current_option = ResourceTypeToFilterOption(resource_type);
+  for (const scoped_refptr<Engine>& engine : engines->data) {
+    if (engine->client(shard)->matches(spec.c_str(), current_option,
+                                  tab_host.c_str())) {
+      return false;
+    }
   }
 
   return true;
 }
 
+void AdBlockBaseService::SetListEngine(const std::string& list_id,
+                                       scoped_refptr<Engine> engine) {
+  {
+    base::AutoLock lock(engine_lock_);
+    if (engine) {
+      lists_[list_id] = std::move(engine);
+    } else {
+      lists_.erase(list_id);
+    }
+
+    std::vector<scoped_refptr<Engine>> engines;
+    for (const auto& list : lists_) {
+      engines.push_back(list.second);
+    }
+    engines_ = engines.empty() ? nullptr :
+        base::MakeRefCounted<EngineList>(std::move(engines));
+  }
+  IncrementDATFileEngineGeneration();
+}
+
+scoped_refptr<AdBlockBaseService::EngineList>
+AdBlockBaseService::GetEngines() {
+  base::AutoLock lock(engine_lock_);
+  return engines_;
+}
+
 void AdBlockBaseService::GetDATFileData(const base::FilePath& dat_file_path) {
-  GetTaskRunner()->PostTaskAndReply(
+  GetTaskRunner()->PostTask(
       FROM_HERE,
-      base::Bind(&brave_shields::GetDATFileData, dat_file_path, &buffer_),
-      base::Bind(&AdBlockBaseService::OnDATFileDataReady,
-                 weak_factory_.GetWeakPtr()));
+      base::Bind(&AdBlockBaseService::LoadDATFileOnTaskRunner,
+                 base::Unretained(this), dat_file_path));
 }
 
-void AdBlockBaseService::OnDATFileDataReady() {
-  if (buffer_.empty()) {
-    LOG(ERROR) << "Could not obtain ad block data";
-    return;
-  }
-  ad_block_client_.reset(new AdBlockClient());
-  if (!ad_block_client_->deserialize((char*)&buffer_.front())) {
-    ad_block_client_.reset();
-    LOG(ERROR) << "Failed to deserialize ad block data";
+void AdBlockBaseService::LoadDATFileOnTaskRunner(
+    const base::FilePath& dat_file_path) {
+  scoped_refptr<Engine> engine =
+      Engine::Load(dat_file_path, GetMatchingShardCount());
+  if (!engine) {
+    LOG(ERROR) << "Could not load ad block data";
     return;
   }
+
+  OnDATFileEngineLoaded(std::move(engine));
+}
+
+void AdBlockBaseService::OnDATFileEngineLoaded(
+    scoped_refptr<Engine> engine) {
+  SetListEngine(std::string(), std::move(engine));
 }
 
 bool AdBlockBaseService::Init() {
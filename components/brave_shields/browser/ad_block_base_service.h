@@ -7,13 +7,14 @@
 
 #include <stdint.h>
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "base/files/file_path.h"
-#include "base/memory/weak_ptr.h"
-#include "base/sequence_checker.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_shields/browser/dat_file_util.h"
 #include "content/public/common/resource_type.h"
@@ -23,30 +24,52 @@ class AdBlockClient;
 namespace brave_shields {
 
 // The base class of the brave shields service in charge of ad-block
-// checking and init.
+// checking and init. ShouldStartRequest() runs on GetMatchingTaskRunner(),
+// whose sequences are shared by all ad-block and tracking protection
+// services.
+//
+// A service can hold several filter lists, e.g. the default list and any
+// number of regional or custom lists. All of them are evaluated for a
+// request in one pass; each list decides on its own, with its exception
+// rules only applying to its blocking rules, and the request is blocked if
+// any list blocks it.
 class AdBlockBaseService : public BaseBraveShieldsService {
  public:
+  using Engine = DATFileEngine<AdBlockClient>;
+
   AdBlockBaseService();
   ~AdBlockBaseService() override;
 
   bool ShouldStartRequest(const GURL &url,
     content::ResourceType resource_type,
-    const std::string& tab_host) override;
+    const std::string& tab_host,
+    size_t shard) override;
+
+  // Adds, replaces or, if |engine| is null, removes the list |list_id|.
+  void SetListEngine(const std::string& list_id, scoped_refptr<Engine> engine);
 
  protected:
   bool Init() override;
   void Cleanup() override;
 
   void GetDATFileData(const base::FilePath& dat_file_path);
-
-  std::unique_ptr<AdBlockClient> ad_block_client_;
-  DATFileDataBuffer buffer_;
+  // Called on the task runner with the engine loaded by GetDATFileData().
+  // Installs it as this service's own list by default.
+  virtual void OnDATFileEngineLoaded(scoped_refptr<Engine> engine);
 
  private:
-  void OnDATFileDataReady();
+  using EngineList = base::RefCountedData<std::vector<scoped_refptr<Engine>>>;
+
+  void LoadDATFileOnTaskRunner(const base::FilePath& dat_file_path);
+  scoped_refptr<EngineList> GetEngines();
+
+  // Guards |lists_| and swapping |engines_|; matching runs on a reference
+  // taken under the lock, without holding it.
+  base::Lock engine_lock_;
+  std::map<std::string, scoped_refptr<Engine>> lists_;
+  // Immutable snapshot of |lists_|, rebuilt whenever a list changes.
+  scoped_refptr<EngineList> engines_;
 
-  SEQUENCE_CHECKER(sequence_checker_);
-  base::WeakPtrFactory<AdBlockBaseService> weak_factory_;
   DISALLOW_COPY_AND_ASSIGN(AdBlockBaseService);
 };
 
@@ -112,6 +112,17 @@ void AdBlockRegionalService::OnComponentReady(
   AdBlockBaseService::GetDATFileData(dat_file_path);
 }
 
+void AdBlockRegionalService::Cleanup() {
+  g_brave_browser_process->ad_block_service()->SetListEngine(uuid_, nullptr);
+  AdBlockBaseService::Cleanup();
+}
+
+void AdBlockRegionalService::OnDATFileEngineLoaded(
+    scoped_refptr<Engine> engine) {
+  g_brave_browser_process->ad_block_service()->SetListEngine(
+      uuid_, std::move(engine));
+}
+
 // static
 bool AdBlockRegionalService::IsSupportedLocale(const std::string& locale) {
   return (FindFilterListByLocale(locale) != region_lists.end());
@@ -136,6 +147,12 @@ scoped_refptr<base::SequencedTaskRunner> AdBlockRegionalService::GetTaskRunner()
   return g_brave_browser_process->ad_block_service()->GetTaskRunner();
 }
 
+scoped_refptr<base::SequencedTaskRunner>
+AdBlockRegionalService::GetMatchingTaskRunner(size_t shard) {
+  return g_brave_browser_process->ad_block_service()->GetMatchingTaskRunner(
+      shard);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // The brave shields factory. Using the Brave Shields as a singleton
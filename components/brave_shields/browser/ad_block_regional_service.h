@@ -30,6 +30,8 @@ class AdBlockRegionalService : public AdBlockBaseService {
   std::string GetUUID() const { return uuid_; }
   std::string GetTitle() const { return title_; }
   scoped_refptr<base::SequencedTaskRunner> GetTaskRunner() override;
+  scoped_refptr<base::SequencedTaskRunner> GetMatchingTaskRunner(
+      size_t shard) override;
 
  protected:
   bool Init() override;
@@ -37,6 +39,10 @@ class AdBlockRegionalService : public AdBlockBaseService {
   void OnComponentReady(const std::string& component_id,
                         const base::FilePath& install_dir,
                         const std::string& manifest) override;
+  void Cleanup() override;
+  // The regional list is matched by AdBlockService, together with the
+  // default list, rather than by this service.
+  void OnDATFileEngineLoaded(scoped_refptr<Engine> engine) override;
 
  private:
   friend class ::AdBlockServiceTest;
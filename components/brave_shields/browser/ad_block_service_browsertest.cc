@@ -9,6 +9,7 @@
 #include "brave/common/pref_names.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/ad_block_regional_service.h"
+#include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 #include "chrome/browser/ui/browser.h"
 #include "chrome/browser/extensions/extension_browsertest.h"
 #include "chrome/test/base/ui_test_utils.h"
@@ -47,6 +48,8 @@ public:
 
   void SetUp() override {
     InitEmbeddedTestServer();
+    brave_shields::BraveShieldsWebContentsObserver::
+        SetBlockedEventBatchingEnabledForTesting(false);
     ExtensionBrowserTest::SetUp();
   }
 
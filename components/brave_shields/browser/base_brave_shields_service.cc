@@ -14,10 +14,17 @@
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/sys_info.h"
 #include "base/task_runner_util.h"
 #include "base/task/post_task.h"
 #include "base/threading/thread_restrictions.h"
 
+namespace {
+
+const size_t kMaxMatchingShards = 4;
+
+}  // namespace
+
 namespace brave_shields {
 
 BaseBraveShieldsService::BaseBraveShieldsService()
@@ -26,6 +33,12 @@ BaseBraveShieldsService::BaseBraveShieldsService()
           base::CreateSequencedTaskRunnerWithTraits({base::MayBlock(),
               base::TaskPriority::USER_VISIBLE,
               base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN})) {
+  for (size_t shard = 1; shard < GetMatchingShardCount(); ++shard) {
+    matching_task_runners_.push_back(
+        base::CreateSequencedTaskRunnerWithTraits({
+            base::TaskPriority::USER_VISIBLE,
+            base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN}));
+  }
 }
 
 BaseBraveShieldsService::~BaseBraveShieldsService() {
@@ -59,7 +72,8 @@ void BaseBraveShieldsService::Stop() {
 
 bool BaseBraveShieldsService::ShouldStartRequest(const GURL& url,
     content::ResourceType resource_type,
-    const std::string& tab_host) {
+    const std::string& tab_host,
+    size_t shard) {
   return true;
 }
 
@@ -67,4 +81,21 @@ scoped_refptr<base::SequencedTaskRunner> BaseBraveShieldsService::GetTaskRunner(
   return task_runner_;
 }
 
+scoped_refptr<base::SequencedTaskRunner>
+BaseBraveShieldsService::GetMatchingTaskRunner(size_t shard) {
+  DCHECK_LT(shard, GetMatchingShardCount());
+  if (shard == 0) {
+    return GetTaskRunner();
+  }
+  return matching_task_runners_[shard - 1];
+}
+
+// static
+size_t BaseBraveShieldsService::GetMatchingShardCount() {
+  static const size_t shard_count = std::max<size_t>(1,
+      std::min<size_t>(kMaxMatchingShards,
+                       base::SysInfo::NumberOfProcessors() / 2));
+  return shard_count;
+}
+
 }  // namespace brave_shields
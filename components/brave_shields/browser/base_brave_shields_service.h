@@ -5,6 +5,7 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BASE_BRAVE_SHIELDS_SERVICE_H_
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BASE_BRAVE_SHIELDS_SERVICE_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <memory>
@@ -29,10 +30,21 @@ class BaseBraveShieldsService : public BraveComponentExtension {
   bool Start();
   void Stop();
   bool IsInitialized() const;
+  // Runs on GetMatchingTaskRunner(|shard|), using that shard's clients of
+  // the engines.
   virtual bool ShouldStartRequest(const GURL& url,
       content::ResourceType resource_type,
-      const std::string& tab_host);
+      const std::string& tab_host,
+      size_t shard);
   virtual scoped_refptr<base::SequencedTaskRunner> GetTaskRunner();
+  // Returns the sequence requests of matching shard |shard| are matched on.
+  // Shard 0 is matched on GetTaskRunner().
+  virtual scoped_refptr<base::SequencedTaskRunner> GetMatchingTaskRunner(
+      size_t shard);
+
+  // Requests are matched on this many sequences in parallel. Every shard
+  // holds its own clients of the engines, so the count is kept small.
+  static size_t GetMatchingShardCount();
 
  protected:
   virtual bool Init() = 0;
@@ -44,6 +56,9 @@ class BaseBraveShieldsService : public BraveComponentExtension {
   bool initialized_;
   std::mutex initialized_mutex_;
   scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  // The sequences of shards 1 and up.
+  std::vector<scoped_refptr<base::SequencedTaskRunner>>
+      matching_task_runners_;
 };
 
 }  // namespace brave_shields
@@ -0,0 +1,79 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/bloom_filter.h"
+
+#include <algorithm>
+
+namespace {
+
+// 10 bits per item and 7 probes give a false positive rate just under 1%.
+const size_t kBitsPerItem = 10;
+const size_t kProbeCount = 7;
+
+// 64-bit FNV-1a. Two halves of the hash seed the double hashing scheme used
+// to derive the probe positions.
+uint64_t HashItem(base::StringPiece item) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (char c : item) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+}  // namespace
+
+namespace brave_shields {
+
+BloomFilter::BloomFilter() : bit_count_(0) {
+}
+
+BloomFilter::BloomFilter(size_t expected_items)
+    : bits_((std::max<size_t>(expected_items, 1) * kBitsPerItem + 63) / 64),
+      bit_count_(bits_.size() * 64) {
+}
+
+BloomFilter::BloomFilter(const BloomFilter& other) = default;
+
+BloomFilter& BloomFilter::operator=(const BloomFilter& other) = default;
+
+BloomFilter::~BloomFilter() {
+}
+
+void BloomFilter::Add(base::StringPiece item) {
+  if (empty()) {
+    return;
+  }
+  const uint64_t hash = HashItem(item);
+  const uint32_t h1 = static_cast<uint32_t>(hash);
+  const uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+  for (size_t i = 0; i < kProbeCount; ++i) {
+    const size_t bit = (h1 + i * h2) % bit_count_;
+    bits_[bit / 64] |= (1ULL << (bit % 64));
+  }
+}
+
+bool BloomFilter::MayContain(base::StringPiece item) const {
+  if (empty()) {
+    return false;
+  }
+  const uint64_t hash = HashItem(item);
+  const uint32_t h1 = static_cast<uint32_t>(hash);
+  const uint32_t h2 = static_cast<uint32_t>(hash >> 32) | 1;
+  for (size_t i = 0; i < kProbeCount; ++i) {
+    const size_t bit = (h1 + i * h2) % bit_count_;
+    if (!(bits_[bit / 64] & (1ULL << (bit % 64)))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BloomFilter::Clear() {
+  bits_.clear();
+  bit_count_ = 0;
+}
+
+}  // namespace brave_shields
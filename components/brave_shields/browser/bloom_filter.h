@@ -0,0 +1,42 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BLOOM_FILTER_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BLOOM_FILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/strings/string_piece.h"
+
+namespace brave_shields {
+
+// A fixed size bloom filter over strings. MayContain() never returns false
+// for an added string, and returns true for a string that was not added
+// with a probability of roughly 1% when sized for the number of items
+// actually added. An empty filter contains nothing.
+class BloomFilter {
+ public:
+  BloomFilter();
+  explicit BloomFilter(size_t expected_items);
+  BloomFilter(const BloomFilter& other);
+  BloomFilter& operator=(const BloomFilter& other);
+  ~BloomFilter();
+
+  void Add(base::StringPiece item);
+  bool MayContain(base::StringPiece item) const;
+
+  void Clear();
+  bool empty() const { return bits_.empty(); }
+
+ private:
+  std::vector<uint64_t> bits_;
+  size_t bit_count_;
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_BLOOM_FILTER_H_
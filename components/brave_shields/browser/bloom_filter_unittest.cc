@@ -0,0 +1,40 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/bloom_filter.h"
+
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::BloomFilter;
+
+TEST(BloomFilterTest, EmptyFilterContainsNothing) {
+  BloomFilter filter;
+  filter.Add("com.brave");
+  EXPECT_FALSE(filter.MayContain("com.brave"));
+}
+
+TEST(BloomFilterTest, NoFalseNegatives) {
+  const int kItems = 10000;
+  BloomFilter filter(kItems);
+  for (int i = 0; i < kItems; ++i) {
+    filter.Add("com.example" + base::IntToString(i));
+  }
+  for (int i = 0; i < kItems; ++i) {
+    EXPECT_TRUE(filter.MayContain("com.example" + base::IntToString(i)));
+  }
+
+  int false_positives = 0;
+  for (int i = 0; i < kItems; ++i) {
+    if (filter.MayContain("org.example" + base::IntToString(i))) {
+      false_positives++;
+    }
+  }
+  EXPECT_LT(false_positives, kItems / 50);
+
+  filter.Clear();
+  EXPECT_FALSE(filter.MayContain("com.example0"));
+}
@@ -4,12 +4,22 @@
 
 #include "brave/components/brave_shields/browser/brave_shields_util.h"
 
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
 #include "base/task/post_task.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "brave/common/shield_exceptions.h"
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/common/brave_shield_constants.h"
 #include "chrome/browser/extensions/extension_tab_util.h"
 #include "chrome/browser/profiles/profile_io_data.h"
+#include "brave/components/content_settings/core/browser/brave_content_settings_pref_provider.h"
 #include "components/content_settings/core/browser/host_content_settings_map.h"
 #include "components/content_settings/core/common/content_settings_types.h"
 #include "components/content_settings/core/common/content_settings_utils.h"
@@ -28,8 +38,103 @@ using content::ResourceRequestInfo;
 using net::URLRequest;
 using namespace net::registry_controlled_domains;
 
+#define SHIELDS_SETTINGS_CACHE_SIZE 500
+#define BLOCKED_EVENTS_FLUSH_DELAY_MS 100
+
 namespace brave_shields {
 
+namespace {
+
+// Shields settings of recently seen tab origins, keyed by profile and origin.
+// Only used on the IO thread. Everything is dropped as soon as any shields
+// setting changes or a profile goes away.
+class ShieldsSettingsCache {
+ public:
+  using Key = std::pair<HostContentSettingsMap*, std::string>;
+
+  ShieldsSettingsCache()
+      : settings_(SHIELDS_SETTINGS_CACHE_SIZE),
+        version_(content_settings::GetBraveShieldsSettingsVersion()) {
+  }
+
+  bool Get(const Key& key, ShieldsSettings* settings) {
+    DCHECK_CURRENTLY_ON(BrowserThread::IO);
+    const uint32_t version = content_settings::GetBraveShieldsSettingsVersion();
+    if (version != version_) {
+      settings_.Clear();
+      version_ = version;
+      return false;
+    }
+    auto it = settings_.Get(key);
+    if (it == settings_.end()) {
+      return false;
+    }
+    *settings = it->second;
+    return true;
+  }
+
+  // |version| is the settings version |settings| were read with.
+  void Put(const Key& key, uint32_t version, const ShieldsSettings& settings) {
+    DCHECK_CURRENTLY_ON(BrowserThread::IO);
+    if (version != version_) {
+      return;
+    }
+    settings_.Put(key, settings);
+  }
+
+ private:
+  base::MRUCache<Key, ShieldsSettings> settings_;
+  uint32_t version_;
+
+  DISALLOW_COPY_AND_ASSIGN(ShieldsSettingsCache);
+};
+
+ShieldsSettingsCache* GetShieldsSettingsCache() {
+  static base::NoDestructor<ShieldsSettingsCache> cache;
+  return cache.get();
+}
+
+// Blocked events of the IO thread, handed to the UI thread in one task at
+// most every BLOCKED_EVENTS_FLUSH_DELAY_MS. Only used on the IO thread.
+class BlockedEventBatch {
+ public:
+  using BlockedEvent = BraveShieldsWebContentsObserver::BlockedEvent;
+
+  BlockedEventBatch() {}
+
+  void Add(BlockedEvent event) {
+    DCHECK_CURRENTLY_ON(BrowserThread::IO);
+    events_.push_back(std::move(event));
+    if (!flush_timer_.IsRunning()) {
+      flush_timer_.Start(FROM_HERE,
+          base::TimeDelta::FromMilliseconds(BLOCKED_EVENTS_FLUSH_DELAY_MS),
+          base::Bind(&BlockedEventBatch::Flush, base::Unretained(this)));
+    }
+  }
+
+ private:
+  void Flush() {
+    DCHECK_CURRENTLY_ON(BrowserThread::IO);
+    std::vector<BlockedEvent> events;
+    events.swap(events_);
+    base::PostTaskWithTraits(FROM_HERE, {BrowserThread::UI},
+        base::BindOnce(&BraveShieldsWebContentsObserver::DispatchBlockedEvents,
+            std::move(events)));
+  }
+
+  std::vector<BlockedEvent> events_;
+  base::OneShotTimer flush_timer_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockedEventBatch);
+};
+
+BlockedEventBatch* GetBlockedEventBatch() {
+  static base::NoDestructor<BlockedEventBatch> batch;
+  return batch.get();
+}
+
+}  // namespace
+
 bool GetDefaultFromResourceIdentifier(const std::string& resource_identifier,
     const GURL& primary_url, const GURL& secondary_url) {
   if (resource_identifier == brave_shields::kAds) {
@@ -48,6 +153,53 @@ bool GetDefaultFromResourceIdentifier(const std::string& resource_identifier,
   return false;
 }
 
+ShieldsSettings GetShieldsSettingsFromIO(const net::URLRequest* request,
+    const GURL& tab_origin) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  const content::ResourceRequestInfo* resource_info =
+      content::ResourceRequestInfo::ForRequest(request);
+  ProfileIOData* io_data = resource_info ?
+      ProfileIOData::FromResourceContext(resource_info->GetContext()) :
+      nullptr;
+  return GetShieldsSettingsWithIOData(io_data, tab_origin);
+}
+
+ShieldsSettings GetShieldsSettingsWithIOData(ProfileIOData* io_data,
+    const GURL& tab_origin) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  ShieldsSettingsCache::Key key(
+      io_data ? io_data->GetHostContentSettingsMap() : nullptr,
+      tab_origin.spec());
+  ShieldsSettings settings;
+  if (GetShieldsSettingsCache()->Get(key, &settings)) {
+    return settings;
+  }
+
+  // Read the version first so that a change made while the settings below
+  // are looked up keeps them out of the cache.
+  const uint32_t version = content_settings::GetBraveShieldsSettingsVersion();
+  settings.allow_brave_shields = IsAllowContentSettingWithIOData(
+      io_data, tab_origin, tab_origin, CONTENT_SETTINGS_TYPE_PLUGINS,
+      kBraveShields);
+  settings.allow_ads = IsAllowContentSettingWithIOData(
+      io_data, tab_origin, tab_origin, CONTENT_SETTINGS_TYPE_PLUGINS, kAds);
+  settings.allow_http_upgradable_resources = IsAllowContentSettingWithIOData(
+      io_data, tab_origin, tab_origin, CONTENT_SETTINGS_TYPE_PLUGINS,
+      kHTTPUpgradableResources);
+  settings.allow_1p_cookies = IsAllowContentSettingWithIOData(
+      io_data, tab_origin, GURL("https://firstParty/"),
+      CONTENT_SETTINGS_TYPE_PLUGINS, kCookies);
+  settings.allow_3p_cookies = IsAllowContentSettingWithIOData(
+      io_data, tab_origin, GURL(), CONTENT_SETTINGS_TYPE_PLUGINS, kCookies);
+  settings.allow_referrers = IsAllowContentSettingWithIOData(
+      io_data, tab_origin, tab_origin, CONTENT_SETTINGS_TYPE_PLUGINS,
+      kReferrers);
+  GetShieldsSettingsCache()->Put(key, version, settings);
+  return settings;
+}
+
 bool IsAllowContentSettingFromIO(const net::URLRequest* request,
     const GURL& primary_url, const GURL& secondary_url,
     ContentSettingsType setting_type,
@@ -123,10 +275,15 @@ void DispatchBlockedEventFromIO(const GURL &request_url, int render_frame_id,
     int render_process_id, int frame_tree_node_id,
     const std::string& block_type) {
   DCHECK_CURRENTLY_ON(BrowserThread::IO);
-  base::PostTaskWithTraits(FROM_HERE, {BrowserThread::UI},
-      base::BindOnce(&BraveShieldsWebContentsObserver::DispatchBlockedEvent,
-          block_type, request_url.spec(),
-          render_process_id, render_frame_id, frame_tree_node_id));
+  if (!BraveShieldsWebContentsObserver::IsBlockedEventBatchingEnabled()) {
+    base::PostTaskWithTraits(FROM_HERE, {BrowserThread::UI},
+        base::BindOnce(&BraveShieldsWebContentsObserver::DispatchBlockedEvent,
+            block_type, request_url.spec(),
+            render_process_id, render_frame_id, frame_tree_node_id));
+    return;
+  }
+  GetBlockedEventBatch()->Add({block_type, request_url.spec(),
+      render_process_id, render_frame_id, frame_tree_node_id});
 }
 
 bool ShouldSetReferrer(bool allow_referrers, bool shields_up,
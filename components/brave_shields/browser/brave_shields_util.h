@@ -24,6 +24,26 @@ class ProfileIOData;
 
 namespace brave_shields {
 
+// All shields settings which apply to requests made from a tab origin.
+struct ShieldsSettings {
+  bool allow_brave_shields = true;
+  bool allow_ads = false;
+  bool allow_http_upgradable_resources = false;
+  bool allow_1p_cookies = true;
+  bool allow_3p_cookies = false;
+  bool allow_referrers = false;
+};
+
+// Returns the shields settings for |tab_origin|. Only called on the IO
+// thread, where results are cached per profile and tab origin until a shields
+// setting changes, so a request costs a single cache lookup instead of one
+// content settings map lookup per setting.
+ShieldsSettings GetShieldsSettingsWithIOData(ProfileIOData* io_data,
+    const GURL& tab_origin);
+
+ShieldsSettings GetShieldsSettingsFromIO(const net::URLRequest* request,
+    const GURL& tab_origin);
+
 bool IsAllowContentSettingWithIOData(ProfileIOData* io_data,
     const GURL& primary_url, const GURL& secondary_url,
     ContentSettingsType setting_type,
@@ -4,7 +4,14 @@
 
 #include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 
+#include <memory>
+#include <string>
+
+#include "base/memory/ptr_util.h"
+#include "base/metrics/histogram_macros_local.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/supports_user_data.h"
+#include "base/time/time.h"
 #include "brave/common/extensions/api/brave_shields.h"
 #include "brave/common/pref_names.h"
 #include "brave/common/render_messages.h"
@@ -15,6 +22,7 @@
 #include "chrome/browser/extensions/extension_tab_util.h"
 #include "chrome/browser/profiles/profile.h"
 #include "chrome/common/renderer_configuration.mojom.h"
+#include "components/content_settings/core/browser/content_settings_observer.h"
 #include "components/content_settings/core/browser/host_content_settings_map.h"
 #include "components/content_settings/core/common/content_settings_utils.h"
 #include "components/prefs/pref_registry_simple.h"
@@ -26,6 +34,7 @@
 #include "content/public/browser/navigation_handle.h"
 #include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/render_process_host.h"
+#include "content/public/browser/render_process_host_observer.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/browser/web_contents_user_data.h"
 #include "extensions/browser/event_router.h"
@@ -34,6 +43,129 @@
 
 namespace {
 
+const char kContentSettingRulesCacheKey[] =
+    "brave_shields_content_setting_rules_cache";
+const char kRendererContentSettingRulesVersionKey[] =
+    "brave_shields_renderer_content_setting_rules_version";
+
+// Versions of RendererContentSettingRules across all profiles, only used on
+// the UI thread.
+uint64_t g_next_content_setting_rules_version = 1;
+
+// The version of the content setting rules a renderer process was sent.
+// Reset when the process exits, since a relaunched process starts without
+// rules.
+class RendererRulesVersion : public base::SupportsUserData::Data,
+                             public content::RenderProcessHostObserver {
+ public:
+  explicit RendererRulesVersion(content::RenderProcessHost* process)
+      : process_(process), version_(0) {
+    process_->AddObserver(this);
+  }
+  ~RendererRulesVersion() override {
+    if (process_) {
+      process_->RemoveObserver(this);
+    }
+  }
+
+  static RendererRulesVersion* FromProcess(
+      content::RenderProcessHost* process) {
+    RendererRulesVersion* version = static_cast<RendererRulesVersion*>(
+        process->GetUserData(kRendererContentSettingRulesVersionKey));
+    if (!version) {
+      version = new RendererRulesVersion(process);
+      process->SetUserData(kRendererContentSettingRulesVersionKey,
+                           base::WrapUnique(version));
+    }
+    return version;
+  }
+
+  uint64_t version() const { return version_; }
+  void set_version(uint64_t version) { version_ = version; }
+
+  // content::RenderProcessHostObserver
+  void RenderProcessExited(
+      content::RenderProcessHost* host,
+      const content::ChildProcessTerminationInfo& info) override {
+    version_ = 0;
+  }
+  void RenderProcessHostDestroyed(content::RenderProcessHost* host) override {
+    process_->RemoveObserver(this);
+    process_ = nullptr;
+  }
+
+ private:
+  content::RenderProcessHost* process_;
+  uint64_t version_;
+
+  DISALLOW_COPY_AND_ASSIGN(RendererRulesVersion);
+};
+
+// The RendererContentSettingRules of a profile. They are only rebuilt after
+// one of its content settings changed, and each version is sent once to
+// each renderer process, whose frames all share them.
+class ContentSettingRulesCache : public base::SupportsUserData::Data,
+                                 public content_settings::Observer {
+ public:
+  explicit ContentSettingRulesCache(HostContentSettingsMap* map)
+      : map_(map), version_(0) {
+    map_->AddObserver(this);
+  }
+  ~ContentSettingRulesCache() override {
+    map_->RemoveObserver(this);
+  }
+
+  static ContentSettingRulesCache* FromProfile(Profile* profile) {
+    ContentSettingRulesCache* cache = static_cast<ContentSettingRulesCache*>(
+        profile->GetUserData(kContentSettingRulesCacheKey));
+    if (!cache) {
+      cache = new ContentSettingRulesCache(
+          HostContentSettingsMapFactory::GetForProfile(profile));
+      profile->SetUserData(kContentSettingRulesCacheKey,
+                           base::WrapUnique(cache));
+    }
+    return cache;
+  }
+
+  // Sends the rules to |process| unless it already has this version.
+  void UpdateRenderProcess(content::RenderProcessHost* process) {
+    if (!version_) {
+      rules_ = RendererContentSettingRules();
+      GetRendererContentSettingRules(map_.get(), &rules_);
+      version_ = g_next_content_setting_rules_version++;
+    }
+    RendererRulesVersion* sent = RendererRulesVersion::FromProcess(process);
+    if (sent->version() == version_) {
+      return;
+    }
+    IPC::ChannelProxy* channel = process->GetChannel();
+    // channel might be NULL in tests.
+    if (channel) {
+      chrome::mojom::RendererConfigurationAssociatedPtr rc_interface;
+      channel->GetRemoteAssociatedInterface(&rc_interface);
+      rc_interface->SetContentSettingRules(rules_);
+      sent->set_version(version_);
+    }
+  }
+
+  // content_settings::Observer
+  void OnContentSettingChanged(
+      const ContentSettingsPattern& primary_pattern,
+      const ContentSettingsPattern& secondary_pattern,
+      ContentSettingsType content_type,
+      const std::string& resource_identifier) override {
+    version_ = 0;
+  }
+
+ private:
+  scoped_refptr<HostContentSettingsMap> map_;
+  RendererContentSettingRules rules_;
+  // 0 if |rules_| are out of date.
+  uint64_t version_;
+
+  DISALLOW_COPY_AND_ASSIGN(ContentSettingRulesCache);
+};
+
 // Content Settings are only sent to the main frame currently.
 // Chrome may fix this at some point, but for now we do this as a work-around.
 // You can verify if this is fixed by running the following test:
@@ -41,23 +173,16 @@ namespace {
 // Chrome seems to also have a bug with RenderFrameHostChanged not updating the content settings
 // so this is fixed here too. That case is coveredd in tests by:
 // npm run test -- brave_browser_tests --filter=BraveContentSettingsObserverBrowserTest.*
-void UpdateContentSettingsToRendererFrames(content::WebContents* web_contents) {
-  for (content::RenderFrameHost* frame : web_contents->GetAllFrames()) {
-    Profile* profile =
-        Profile::FromBrowserContext(web_contents->GetBrowserContext());
-    const HostContentSettingsMap* map =
-        HostContentSettingsMapFactory::GetForProfile(profile);
-    RendererContentSettingRules rules;
-    GetRendererContentSettingRules(map, &rules);
-    IPC::ChannelProxy* channel =
-        frame->GetProcess()->GetChannel();
-    // channel might be NULL in tests.
-    if (channel) {
-      chrome::mojom::RendererConfigurationAssociatedPtr rc_interface;
-      channel->GetRemoteAssociatedInterface(&rc_interface);
-      rc_interface->SetContentSettingRules(rules);
-    }
-  }
+// The rules are per renderer process, so only the process of |rfh| needs
+// them, and only if they changed since it was last sent them.
+void UpdateContentSettingsToRendererFrame(content::RenderFrameHost* rfh) {
+  const base::TimeTicks start_time = base::TimeTicks::Now();
+  content::RenderProcessHost* process = rfh->GetProcess();
+  Profile* profile = Profile::FromBrowserContext(process->GetBrowserContext());
+  ContentSettingRulesCache::FromProfile(profile)->UpdateRenderProcess(process);
+  LOCAL_HISTOGRAM_CUSTOM_COUNTS(
+      "Brave.Shields.UpdateContentSettingsMicroseconds",
+      (base::TimeTicks::Now() - start_time).InMicroseconds(), 1, 1000000, 50);
 }
 
 }  // namespace
@@ -90,35 +215,15 @@ WebContents* GetWebContents(
 
 }  // namespace
 
-namespace brave_shields {
+#define PERSIST_BLOCKED_COUNTERS_DELAY_SECONDS 2
 
-base::Lock BraveShieldsWebContentsObserver::frame_data_map_lock_;
-std::map<BraveShieldsWebContentsObserver::RenderFrameIdKey, GURL>
-    BraveShieldsWebContentsObserver::frame_key_to_tab_url_;
-std::map<int, GURL>
-    BraveShieldsWebContentsObserver::frame_tree_node_id_to_tab_url_;
+namespace brave_shields {
 
-BraveShieldsWebContentsObserver::RenderFrameIdKey::RenderFrameIdKey()
-    : render_process_id(content::ChildProcessHost::kInvalidUniqueID),
-      frame_routing_id(MSG_ROUTING_NONE) {}
+namespace {
 
-BraveShieldsWebContentsObserver::RenderFrameIdKey::RenderFrameIdKey(
-    int render_process_id,
-    int frame_routing_id)
-    : render_process_id(render_process_id),
-      frame_routing_id(frame_routing_id) {}
-
-bool BraveShieldsWebContentsObserver::RenderFrameIdKey::operator<(
-    const RenderFrameIdKey& other) const {
-  return std::tie(render_process_id, frame_routing_id) <
-         std::tie(other.render_process_id, other.frame_routing_id);
-}
+bool g_blocked_event_batching_enabled = true;
 
-bool BraveShieldsWebContentsObserver::RenderFrameIdKey::operator==(
-    const RenderFrameIdKey& other) const {
-  return render_process_id == other.render_process_id &&
-         frame_routing_id == other.frame_routing_id;
-}
+}  // namespace
 
 BraveShieldsWebContentsObserver::~BraveShieldsWebContentsObserver() {
 }
@@ -137,22 +242,26 @@ void BraveShieldsWebContentsObserver::RenderFrameCreated(
 
   WebContents* web_contents = WebContents::FromRenderFrameHost(rfh);
   if (web_contents) {
-    UpdateContentSettingsToRendererFrames(web_contents);
+    UpdateContentSettingsToRendererFrame(rfh);
 
-    base::AutoLock lock(frame_data_map_lock_);
-    const RenderFrameIdKey key(rfh->GetProcess()->GetID(), rfh->GetRoutingID());
-    frame_key_to_tab_url_[key] = web_contents->GetURL();
-    frame_tree_node_id_to_tab_url_[rfh->GetFrameTreeNodeId()] =
-        web_contents->GetURL();
+    FrameTabURLRegistry::GetInstance()->AddFrame(rfh->GetProcess()->GetID(),
+        rfh->GetRoutingID(), rfh->GetFrameTreeNodeId(), GetTabURL());
   }
 }
 
 void BraveShieldsWebContentsObserver::RenderFrameDeleted(
     RenderFrameHost* rfh) {
-  base::AutoLock lock(frame_data_map_lock_);
-  const RenderFrameIdKey key(rfh->GetProcess()->GetID(), rfh->GetRoutingID());
-  frame_key_to_tab_url_.erase(key);
-  frame_tree_node_id_to_tab_url_.erase(rfh->GetFrameTreeNodeId());
+  FrameTabURLRegistry::GetInstance()->RemoveFrame(rfh->GetProcess()->GetID(),
+      rfh->GetRoutingID(), rfh->GetFrameTreeNodeId());
+}
+
+scoped_refptr<const FrameTabURLRegistry::TabURL>
+BraveShieldsWebContentsObserver::GetTabURL() {
+  const GURL& url = web_contents()->GetURL();
+  if (!tab_url_ || tab_url_->data != url) {
+    tab_url_ = base::MakeRefCounted<FrameTabURLRegistry::TabURL>(url);
+  }
+  return tab_url_;
 }
 
 void BraveShieldsWebContentsObserver::RenderFrameHostChanged(
@@ -171,33 +280,16 @@ void BraveShieldsWebContentsObserver::DidFinishNavigation(
   if (!web_contents() || !main_frame) {
     return;
   }
-  int process_id = main_frame->GetProcess()->GetID();
-  int routing_id = main_frame->GetRoutingID();
-  int tree_node_id = main_frame->GetFrameTreeNodeId();
-
-  base::AutoLock lock(frame_data_map_lock_);
-  frame_key_to_tab_url_[{process_id, routing_id}] = web_contents()->GetURL();
-  frame_tree_node_id_to_tab_url_[tree_node_id] = web_contents()->GetURL();
+  FrameTabURLRegistry::GetInstance()->AddFrame(
+      main_frame->GetProcess()->GetID(), main_frame->GetRoutingID(),
+      main_frame->GetFrameTreeNodeId(), GetTabURL());
 }
 
 // static
 GURL BraveShieldsWebContentsObserver::GetTabURLFromRenderFrameInfo(
     int render_process_id, int render_frame_id, int render_frame_tree_node_id) {
-  base::AutoLock lock(frame_data_map_lock_);
-  if (-1 != render_process_id && -1 != render_frame_id) {
-    auto iter = frame_key_to_tab_url_.find({render_process_id,
-                                            render_frame_id});
-    if (iter != frame_key_to_tab_url_.end()) {
-      return iter->second;
-    }
-  }
-  if (-1 != render_frame_tree_node_id) {
-    auto iter2 = frame_tree_node_id_to_tab_url_.find(render_frame_tree_node_id);
-    if (iter2 != frame_tree_node_id_to_tab_url_.end()) {
-      return iter2->second;
-    }
-  }
-  return GURL();
+  return FrameTabURLRegistry::GetInstance()->GetTabURL(render_process_id,
+      render_frame_id, render_frame_tree_node_id);
 }
 
 bool BraveShieldsWebContentsObserver::IsBlockedSubresource(
@@ -229,29 +321,90 @@ void BraveShieldsWebContentsObserver::DispatchBlockedEvent(
     if (observer &&
         !observer->IsBlockedSubresource(subresource)) {
       observer->AddBlockedSubresource(subresource);
-      PrefService* prefs = Profile::FromBrowserContext(
-          web_contents->GetBrowserContext())->
-          GetOriginalProfile()->
-          GetPrefs();
-
-      if (block_type == kAds) {
-        prefs->SetUint64(kAdsBlocked, prefs->GetUint64(kAdsBlocked) + 1);
-      } else if (block_type == kTrackers) {
-        prefs->SetUint64(kTrackersBlocked,
-            prefs->GetUint64(kTrackersBlocked) + 1);
-      } else if (block_type == kHTTPUpgradableResources) {
-        prefs->SetUint64(kHttpsUpgrades, prefs->GetUint64(kHttpsUpgrades) + 1);
-      } else if (block_type == kJavaScript) {
-        prefs->SetUint64(kJavascriptBlocked,
-            prefs->GetUint64(kJavascriptBlocked) + 1);
-      } else if (block_type == kFingerprinting) {
-        prefs->SetUint64(kFingerprintingBlocked,
-            prefs->GetUint64(kFingerprintingBlocked) + 1);
-      }
+      observer->IncrementBlockedCounter(block_type);
+    }
+  }
+}
+
+// static
+void BraveShieldsWebContentsObserver::DispatchBlockedEvents(
+    std::vector<BlockedEvent> events) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::UI);
+  for (BlockedEvent& event : events) {
+    DispatchBlockedEvent(std::move(event.block_type),
+        std::move(event.subresource), event.render_process_id,
+        event.render_frame_id, event.frame_tree_node_id);
+  }
+}
+
+// static
+void BraveShieldsWebContentsObserver::SetBlockedEventBatchingEnabledForTesting(
+    bool enabled) {
+  g_blocked_event_batching_enabled = enabled;
+}
+
+// static
+bool BraveShieldsWebContentsObserver::IsBlockedEventBatchingEnabled() {
+  return g_blocked_event_batching_enabled;
+}
+
+void BraveShieldsWebContentsObserver::IncrementBlockedCounter(
+    const std::string& block_type) {
+  if (block_type == kAds) {
+    ads_blocked_++;
+  } else if (block_type == kTrackers) {
+    trackers_blocked_++;
+  } else if (block_type == kHTTPUpgradableResources) {
+    https_upgrades_++;
+  } else if (block_type == kJavaScript) {
+    javascript_blocked_++;
+  } else if (block_type == kFingerprinting) {
+    fingerprinting_blocked_++;
+  } else {
+    return;
+  }
+  if (!IsBlockedEventBatchingEnabled()) {
+    PersistBlockedCounters();
+  } else if (!persist_counters_timer_.IsRunning()) {
+    persist_counters_timer_.Start(FROM_HERE,
+        base::TimeDelta::FromSeconds(PERSIST_BLOCKED_COUNTERS_DELAY_SECONDS),
+        base::Bind(&BraveShieldsWebContentsObserver::PersistBlockedCounters,
+                   base::Unretained(this)));
+  }
+}
+
+void BraveShieldsWebContentsObserver::PersistBlockedCounters() {
+  persist_counters_timer_.Stop();
+  if (!web_contents()) {
+    return;
+  }
+  PrefService* prefs = Profile::FromBrowserContext(
+      web_contents()->GetBrowserContext())->
+      GetOriginalProfile()->
+      GetPrefs();
+  const struct {
+    const char* pref_name;
+    uint64_t* count;
+  } counters[] = {
+    {kAdsBlocked, &ads_blocked_},
+    {kTrackersBlocked, &trackers_blocked_},
+    {kHttpsUpgrades, &https_upgrades_},
+    {kJavascriptBlocked, &javascript_blocked_},
+    {kFingerprintingBlocked, &fingerprinting_blocked_},
+  };
+  for (const auto& counter : counters) {
+    if (*counter.count) {
+      prefs->SetUint64(counter.pref_name,
+          prefs->GetUint64(counter.pref_name) + *counter.count);
+      *counter.count = 0;
     }
   }
 }
 
+void BraveShieldsWebContentsObserver::WebContentsDestroyed() {
+  PersistBlockedCounters();
+}
+
 // static
 void BraveShieldsWebContentsObserver::DispatchBlockedEventForWebContents(
     const std::string& block_type, const std::string& subresource,
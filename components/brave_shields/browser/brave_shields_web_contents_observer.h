@@ -6,8 +6,10 @@
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_H_
 
 #include "base/macros.h"
-#include "base/synchronization/lock.h"
+#include "base/memory/ref_counted.h"
 #include "base/strings/string16.h"
+#include "base/timer/timer.h"
+#include "brave/components/brave_shields/browser/frame_tab_url_registry.h"
 #include "content/public/browser/web_contents_observer.h"
 #include "content/public/browser/web_contents_user_data.h"
 
@@ -35,6 +37,20 @@ class BraveShieldsWebContentsObserver : public content::WebContentsObserver,
       std::string subresource,
       int render_process_id,
       int render_frame_id, int frame_tree_node_id);
+
+  struct BlockedEvent {
+    std::string block_type;
+    std::string subresource;
+    int render_process_id;
+    int render_frame_id;
+    int frame_tree_node_id;
+  };
+  // Dispatches the events collected on the IO thread in one UI task.
+  static void DispatchBlockedEvents(std::vector<BlockedEvent> events);
+  // When disabled, blocked events are dispatched and counted in the prefs
+  // right away. Must be called before any browser thread is started.
+  static void SetBlockedEventBatchingEnabledForTesting(bool enabled);
+  static bool IsBlockedEventBatchingEnabled();
   static GURL GetTabURLFromRenderFrameInfo(int render_process_id,
                                            int render_frame_id,
                                            int render_frame_tree_node_id);
@@ -44,21 +60,6 @@ class BraveShieldsWebContentsObserver : public content::WebContentsObserver,
   void AddBlockedSubresource(const std::string& subresource);
 
  protected:
-    // A set of identifiers that uniquely identifies a RenderFrame.
-  struct RenderFrameIdKey {
-    RenderFrameIdKey();
-    RenderFrameIdKey(int render_process_id, int frame_routing_id);
-
-    // The process ID of the renderer that contains the RenderFrame.
-    int render_process_id;
-
-    // The routing ID of the RenderFrame.
-    int frame_routing_id;
-
-    bool operator<(const RenderFrameIdKey& other) const;
-    bool operator==(const RenderFrameIdKey& other) const;
-  };
-
   // content::WebContentsObserver overrides.
   void RenderFrameCreated(content::RenderFrameHost* host) override;
   void RenderFrameDeleted(content::RenderFrameHost* render_frame_host) override;
@@ -68,6 +69,7 @@ class BraveShieldsWebContentsObserver : public content::WebContentsObserver,
       content::NavigationHandle* navigation_handle) override;
   void DidFinishNavigation(
       content::NavigationHandle* navigation_handle) override;
+  void WebContentsDestroyed() override;
 
   // Invoked if an IPC message is coming from a specific RenderFrameHost.
   bool OnMessageReceived(const IPC::Message& message,
@@ -79,20 +81,30 @@ class BraveShieldsWebContentsObserver : public content::WebContentsObserver,
       content::RenderFrameHost* render_frame_host,
       const base::string16& details);
 
-  // TODO(iefremov): Refactor this away or at least put into base::NoDestructor.
-  // Protects global maps below from being concurrently written on the UI thread
-  // and read on the IO thread.
-  static base::Lock frame_data_map_lock_;
-  static std::map<RenderFrameIdKey, GURL> frame_key_to_tab_url_;
-  static std::map<int, GURL> frame_tree_node_id_to_tab_url_;
+  // Returns the URL of the tab, shared by all of its frames in the
+  // FrameTabURLRegistry.
+  scoped_refptr<const FrameTabURLRegistry::TabURL> GetTabURL();
 
  private:
   friend class content::WebContentsUserData<BraveShieldsWebContentsObserver>;
+  scoped_refptr<const FrameTabURLRegistry::TabURL> tab_url_;
   std::vector<std::string> allowed_script_origins_;
   // We keep a set of the current page's blocked URLs in case the page
   // continually tries to load the same blocked URLs.
   std::set<std::string> blocked_url_paths_;
 
+  // Blocked resource counts which haven't been added to the profile prefs
+  // yet. They are persisted on a timer rather than on every blocked
+  // resource, since ad heavy pages block hundreds of them while loading.
+  void IncrementBlockedCounter(const std::string& block_type);
+  void PersistBlockedCounters();
+  uint64_t ads_blocked_ = 0;
+  uint64_t trackers_blocked_ = 0;
+  uint64_t javascript_blocked_ = 0;
+  uint64_t https_upgrades_ = 0;
+  uint64_t fingerprinting_blocked_ = 0;
+  base::OneShotTimer persist_counters_timer_;
+
   DISALLOW_COPY_AND_ASSIGN(BraveShieldsWebContentsObserver);
 };
 
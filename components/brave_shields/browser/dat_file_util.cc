@@ -4,28 +4,50 @@
 
 #include "brave/components/brave_shields/browser/dat_file_util.h"
 
+#include "base/atomicops.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/logging.h"
+
+namespace {
+
+base::subtle::Atomic32 g_dat_file_engine_generation = 0;
+
+}  // namespace
 
 namespace brave_shields {
 
-void GetDATFileData(const base::FilePath& file_path,
-                    DATFileDataBuffer* buffer) {
+std::unique_ptr<base::MemoryMappedFile> MapDATFile(
+    const base::FilePath& file_path) {
   int64_t size = 0;
-  if (!base::PathExists(file_path) ||
-      !base::GetFileSize(file_path, &size) ||
-      0 == size) {
-    LOG(ERROR) << "GetDATFileData: "
+  if (!base::GetFileSize(file_path, &size) || 0 == size) {
+    LOG(ERROR) << "MapDATFile: "
                << "the dat file is not found or corrupted "
                << file_path;
-    return;
+    return nullptr;
   }
 
-  buffer->resize(size);
-  if (size != base::ReadFile(file_path, (char*)&buffer->front(), size)) {
-    LOG(ERROR) << "GetDATFileData: cannot "
-               << "read dat file " << file_path;
+  std::unique_ptr<base::MemoryMappedFile> file(new base::MemoryMappedFile());
+  if (!file->Initialize(file_path,
+                        base::MemoryMappedFile::READ_WRITE_COPY) ||
+      static_cast<int64_t>(file->length()) != size) {
+    LOG(ERROR) << "MapDATFile: cannot "
+               << "map dat file " << file_path;
+    return nullptr;
   }
+  return file;
+}
+
+char* GetDATFileBuffer(base::MemoryMappedFile* file) {
+  return reinterpret_cast<char*>(file->data());
+}
+
+uint32_t GetDATFileEngineGeneration() {
+  return base::subtle::Acquire_Load(&g_dat_file_engine_generation);
+}
+
+void IncrementDATFileEngineGeneration() {
+  base::subtle::Barrier_AtomicIncrement(&g_dat_file_engine_generation, 1);
 }
 
 }  // namespace brave_shields
@@ -5,20 +5,93 @@
 #ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_DAT_FILE_UTIL_H_
 #define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_DAT_FILE_UTIL_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include "base/callback_forward.h"
-
-namespace base {
-class FilePath;
-}
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
 
 namespace brave_shields {
 
-using DATFileDataBuffer = std::vector<unsigned char>;
+// Maps the DAT file at |file_path| copy-on-write. The engines deserialize
+// in place and keep pointing into the data; pages they never write to stay
+// shared with the OS file cache, and any they do write to become private to
+// the process instead of reaching the file. The component updater installs
+// each version into a new directory, so a mapped file is never truncated or
+// rewritten under an engine. Returns nullptr if the file is missing, empty or
+// couldn't be mapped in full.
+std::unique_ptr<base::MemoryMappedFile> MapDATFile(
+    const base::FilePath& file_path);
+
+// Returns the mapped data in the form the engines' deserialize() takes.
+char* GetDATFileBuffer(base::MemoryMappedFile* file);
+
+// Returns a number that changes whenever any DAT file engine is replaced, so
+// callers can tell when decisions cached from earlier engines went stale.
+uint32_t GetDATFileEngineGeneration();
+void IncrementDATFileEngineGeneration();
+
+// A matching engine (AdBlockClient, CTPParser) deserialized from a DAT file.
+// Matching updates the clients' statistics, so a client must not be used by
+// two matches at once. The engine holds one client per matching shard
+// instead, each deserialized from its own mapping of the file and only used
+// on the sequence of its shard; the mappings are copy-on-write, so the shards
+// share the pages of the file. A component update publishes a whole new
+// engine while in-flight matches keep the old one alive through their
+// reference.
+template <class T>
+class DATFileEngine : public base::RefCountedThreadSafe<DATFileEngine<T>> {
+ public:
+  // Returns null if the file couldn't be mapped or deserialized.
+  static scoped_refptr<DATFileEngine> Load(const base::FilePath& file_path,
+                                           size_t shard_count) {
+    scoped_refptr<DATFileEngine> engine(new DATFileEngine());
+    for (size_t i = 0; i < shard_count; ++i) {
+      Shard shard;
+      shard.file = MapDATFile(file_path);
+      if (!shard.file) {
+        return nullptr;
+      }
+      shard.client.reset(new T());
+      if (!shard.client->deserialize(GetDATFileBuffer(shard.file.get()))) {
+        LOG(ERROR) << "DATFileEngine: cannot "
+                   << "deserialize dat file " << file_path;
+        return nullptr;
+      }
+      engine->shards_.push_back(std::move(shard));
+    }
+    return engine;
+  }
+
+  T* client(size_t shard) const {
+    DCHECK_LT(shard, shards_.size());
+    return shards_[shard].client.get();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<DATFileEngine<T>>;
+
+  struct Shard {
+    // Declared first so the client is destroyed before the data it uses.
+    std::unique_ptr<base::MemoryMappedFile> file;
+    std::unique_ptr<T> client;
+  };
+
+  DATFileEngine() {}
+  ~DATFileEngine() {}
+
+  std::vector<Shard> shards_;
 
-void GetDATFileData(const base::FilePath& file_path,
-                    DATFileDataBuffer* buffer);
+  DISALLOW_COPY_AND_ASSIGN(DATFileEngine);
+};
 
 }  // namespace brave_shields
 
@@ -0,0 +1,120 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/frame_tab_url_registry.h"
+
+#include <utility>
+
+#include "base/no_destructor.h"
+
+namespace {
+
+// Frame tree node ids live in the same key space as process and routing id
+// pairs. Process ids are never negative, so the top bit is free to tell them
+// apart.
+const uint64_t kFrameTreeNodeKeyTag = 1ULL << 63;
+
+uint64_t GetFrameKey(int render_process_id, int render_frame_id) {
+  return (static_cast<uint64_t>(static_cast<uint32_t>(render_process_id))
+          << 32) |
+         static_cast<uint32_t>(render_frame_id);
+}
+
+uint64_t GetFrameTreeNodeKey(int frame_tree_node_id) {
+  return kFrameTreeNodeKeyTag | static_cast<uint32_t>(frame_tree_node_id);
+}
+
+}  // namespace
+
+namespace brave_shields {
+
+FrameTabURLRegistry::Shard::Shard() {
+}
+
+FrameTabURLRegistry::Shard::~Shard() {
+}
+
+FrameTabURLRegistry::FrameTabURLRegistry() {
+}
+
+FrameTabURLRegistry::~FrameTabURLRegistry() {
+}
+
+// static
+FrameTabURLRegistry* FrameTabURLRegistry::GetInstance() {
+  static base::NoDestructor<FrameTabURLRegistry> instance;
+  return instance.get();
+}
+
+void FrameTabURLRegistry::AddFrame(int render_process_id, int render_frame_id,
+    int frame_tree_node_id, scoped_refptr<const TabURL> tab_url) {
+  Set(GetFrameKey(render_process_id, render_frame_id), tab_url);
+  Set(GetFrameTreeNodeKey(frame_tree_node_id), std::move(tab_url));
+}
+
+void FrameTabURLRegistry::RemoveFrame(int render_process_id,
+    int render_frame_id, int frame_tree_node_id) {
+  Erase(GetFrameKey(render_process_id, render_frame_id));
+  Erase(GetFrameTreeNodeKey(frame_tree_node_id));
+}
+
+GURL FrameTabURLRegistry::GetTabURL(int render_process_id,
+    int render_frame_id, int frame_tree_node_id) const {
+  scoped_refptr<const TabURL> tab_url;
+  if (-1 != render_process_id && -1 != render_frame_id) {
+    tab_url = Get(GetFrameKey(render_process_id, render_frame_id));
+  }
+  if (!tab_url && -1 != frame_tree_node_id) {
+    tab_url = Get(GetFrameTreeNodeKey(frame_tree_node_id));
+  }
+  // The URL is copied out after the shard lock has been released.
+  return tab_url ? tab_url->data : GURL();
+}
+
+FrameTabURLRegistry::Shard* FrameTabURLRegistry::GetShard(
+    uint64_t key) const {
+  // Fibonacci hashing, so that consecutive ids land on different shards.
+  const uint64_t hash = key * 0x9E3779B97F4A7C15ULL;
+  return &shards_[(hash >> 32) % kShardCount];
+}
+
+void FrameTabURLRegistry::Set(uint64_t key,
+                              scoped_refptr<const TabURL> tab_url) {
+  Shard* shard = GetShard(key);
+  scoped_refptr<const TabURL> old_tab_url;
+  {
+    base::AutoLock lock(shard->lock);
+    scoped_refptr<const TabURL>& entry = shard->urls[key];
+    old_tab_url = std::move(entry);
+    entry = std::move(tab_url);
+  }
+  // |old_tab_url| is released without holding the lock.
+}
+
+void FrameTabURLRegistry::Erase(uint64_t key) {
+  Shard* shard = GetShard(key);
+  scoped_refptr<const TabURL> old_tab_url;
+  {
+    base::AutoLock lock(shard->lock);
+    auto it = shard->urls.find(key);
+    if (it == shard->urls.end()) {
+      return;
+    }
+    old_tab_url = std::move(it->second);
+    shard->urls.erase(it);
+  }
+}
+
+scoped_refptr<const FrameTabURLRegistry::TabURL> FrameTabURLRegistry::Get(
+    uint64_t key) const {
+  Shard* shard = GetShard(key);
+  base::AutoLock lock(shard->lock);
+  auto it = shard->urls.find(key);
+  if (it == shard->urls.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+}  // namespace brave_shields
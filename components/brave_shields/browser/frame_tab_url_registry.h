@@ -0,0 +1,72 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_FRAME_TAB_URL_REGISTRY_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_FRAME_TAB_URL_REGISTRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "url/gurl.h"
+
+namespace brave_shields {
+
+// Maps render frames to the URL of the tab they belong to. Written on the UI
+// thread as frames come and go, read on the IO thread for requests that have
+// no site_for_cookies.
+//
+// Entries are spread over independently locked shards, and each lock is only
+// held to copy a reference, so readers practically never wait on frame churn
+// in other tabs. All frames of a tab share one immutable TabURL.
+class FrameTabURLRegistry {
+ public:
+  using TabURL = base::RefCountedData<GURL>;
+
+  FrameTabURLRegistry();
+  ~FrameTabURLRegistry();
+
+  static FrameTabURLRegistry* GetInstance();
+
+  void AddFrame(int render_process_id, int render_frame_id,
+                int frame_tree_node_id, scoped_refptr<const TabURL> tab_url);
+  void RemoveFrame(int render_process_id, int render_frame_id,
+                   int frame_tree_node_id);
+
+  // Looks up the frame by process and routing id first, then by frame tree
+  // node id. -1 means unknown. Returns an empty URL if the frame is unknown.
+  GURL GetTabURL(int render_process_id, int render_frame_id,
+                 int frame_tree_node_id) const;
+
+ private:
+  using URLMap = std::unordered_map<uint64_t, scoped_refptr<const TabURL>>;
+
+  // Aligned so that shards next to each other don't share a cache line.
+  struct alignas(64) Shard {
+    Shard();
+    ~Shard();
+
+    mutable base::Lock lock;
+    URLMap urls;
+  };
+
+  static const size_t kShardCount = 32;
+
+  Shard* GetShard(uint64_t key) const;
+  void Set(uint64_t key, scoped_refptr<const TabURL> tab_url);
+  void Erase(uint64_t key);
+  scoped_refptr<const TabURL> Get(uint64_t key) const;
+
+  mutable Shard shards_[kShardCount];
+
+  DISALLOW_COPY_AND_ASSIGN(FrameTabURLRegistry);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_FRAME_TAB_URL_REGISTRY_H_
@@ -0,0 +1,123 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/frame_tab_url_registry.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/atomicops.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::FrameTabURLRegistry;
+
+namespace {
+
+scoped_refptr<const FrameTabURLRegistry::TabURL> MakeTabURL(
+    const std::string& spec) {
+  return base::MakeRefCounted<FrameTabURLRegistry::TabURL>(GURL(spec));
+}
+
+// Keeps creating and deleting frames of |tab_count| tabs until stopped.
+class FrameChurnThread : public base::PlatformThread::Delegate {
+ public:
+  FrameChurnThread(FrameTabURLRegistry* registry, int tab_count)
+      : registry_(registry), tab_count_(tab_count), stop_(0) {
+  }
+
+  void ThreadMain() override {
+    std::vector<scoped_refptr<const FrameTabURLRegistry::TabURL>> tab_urls;
+    for (int tab = 0; tab < tab_count_; ++tab) {
+      tab_urls.push_back(MakeTabURL(
+          "https://tab" + base::IntToString(tab) + ".example.com/"));
+    }
+    while (!base::subtle::Acquire_Load(&stop_)) {
+      // Even frame ids are kept alive by the main thread, odd ones churn.
+      for (int tab = 0; tab < tab_count_; ++tab) {
+        registry_->AddFrame(tab, 1, tab * 2 + 1, tab_urls[tab]);
+      }
+      for (int tab = 0; tab < tab_count_; ++tab) {
+        registry_->RemoveFrame(tab, 1, tab * 2 + 1);
+      }
+    }
+  }
+
+  void Stop() { base::subtle::Release_Store(&stop_, 1); }
+
+ private:
+  FrameTabURLRegistry* registry_;
+  int tab_count_;
+  base::subtle::Atomic32 stop_;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameChurnThread);
+};
+
+}  // namespace
+
+TEST(FrameTabURLRegistryTest, LookupByFrameKeyAndTreeNode) {
+  FrameTabURLRegistry registry;
+  EXPECT_EQ(GURL(), registry.GetTabURL(1, 2, 3));
+
+  registry.AddFrame(1, 2, 3, MakeTabURL("https://brave.com/"));
+  EXPECT_EQ(GURL("https://brave.com/"), registry.GetTabURL(1, 2, -1));
+  EXPECT_EQ(GURL("https://brave.com/"), registry.GetTabURL(-1, -1, 3));
+  // The frame key wins over the frame tree node id.
+  registry.AddFrame(4, 5, 6, MakeTabURL("https://example.com/"));
+  EXPECT_EQ(GURL("https://brave.com/"), registry.GetTabURL(1, 2, 6));
+  // Frame tree node ids don't collide with frame keys.
+  EXPECT_EQ(GURL(), registry.GetTabURL(0, 3, -1));
+
+  registry.RemoveFrame(1, 2, 3);
+  EXPECT_EQ(GURL(), registry.GetTabURL(1, 2, 3));
+  EXPECT_EQ(GURL("https://example.com/"), registry.GetTabURL(4, 5, 6));
+}
+
+// Looks up frames while another thread creates and deletes thousands of
+// frames.
+TEST(FrameTabURLRegistryTest, LookupsDuringFrameChurn) {
+  const int kTabCount = 2000;
+  const int kLookupRounds = 200;
+  FrameTabURLRegistry registry;
+  for (int tab = 0; tab < kTabCount; ++tab) {
+    registry.AddFrame(tab, 0, tab * 2,
+        MakeTabURL("https://tab" + base::IntToString(tab) + ".example.com/"));
+  }
+
+  FrameChurnThread churn(&registry, kTabCount);
+  base::PlatformThreadHandle handle;
+  ASSERT_TRUE(base::PlatformThread::Create(0, &churn, &handle));
+
+  // Failures are only counted while |churn| runs, so that the thread is
+  // always joined before the test checks them.
+  int wrong_tab_urls = 0;
+  int wrong_churned_urls = 0;
+  for (int round = 0; round < kLookupRounds; ++round) {
+    for (int tab = 0; tab < kTabCount; ++tab) {
+      const std::string host = "tab" + base::IntToString(tab) + ".example.com";
+      if (registry.GetTabURL(tab, 0, -1).host() != host)
+        ++wrong_tab_urls;
+      // Churning frames are either unknown or point at the right tab.
+      const GURL url = registry.GetTabURL(-1, -1, tab * 2 + 1);
+      if (!url.is_empty() && url.host() != host)
+        ++wrong_churned_urls;
+    }
+  }
+
+  churn.Stop();
+  base::PlatformThread::Join(handle);
+
+  EXPECT_EQ(0, wrong_tab_urls);
+  EXPECT_EQ(0, wrong_churned_urls);
+
+  // |churn| only stops between rounds, so every churned frame is gone and
+  // every kept one is still there.
+  for (int tab = 0; tab < kTabCount; ++tab) {
+    EXPECT_EQ(GURL(), registry.GetTabURL(tab, 1, tab * 2 + 1));
+    EXPECT_EQ("tab" + base::IntToString(tab) + ".example.com",
+              registry.GetTabURL(tab, 0, tab * 2).host());
+  }
+}
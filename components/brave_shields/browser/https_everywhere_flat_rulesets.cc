@@ -0,0 +1,162 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_flat_rulesets.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "base/files/file_path.h"
+#include "base/logging.h"
+
+namespace {
+
+const uint32_t kFlatRuleSetsMagic = 0x45535448;  // "HTSE"
+const uint32_t kFlatRuleSetsVersion = 1;
+
+struct Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+};
+
+void AppendUint32(uint32_t value, std::string* output) {
+  output->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}  // namespace
+
+namespace brave_shields {
+
+struct HTTPSEFlatRuleSets::Entry {
+  uint32_t key_offset;
+  uint32_t key_size;
+  uint32_t value_offset;
+  uint32_t value_size;
+};
+
+HTTPSEFlatRuleSets::HTTPSEFlatRuleSets()
+    : entries_(nullptr),
+      entry_count_(0) {
+}
+
+HTTPSEFlatRuleSets::~HTTPSEFlatRuleSets() {
+}
+
+// static
+std::unique_ptr<HTTPSEFlatRuleSets> HTTPSEFlatRuleSets::Load(
+    const base::FilePath& path) {
+  std::unique_ptr<HTTPSEFlatRuleSets> rule_sets(new HTTPSEFlatRuleSets());
+  if (!rule_sets->file_.Initialize(path)) {
+    return nullptr;
+  }
+  if (!rule_sets->Validate()) {
+    LOG(ERROR) << "Malformed HTTPS Everywhere ruleset file " << path.value();
+    return nullptr;
+  }
+  return rule_sets;
+}
+
+bool HTTPSEFlatRuleSets::Validate() {
+  const size_t length = file_.length();
+  if (length < sizeof(Header)) {
+    return false;
+  }
+  const Header* header = reinterpret_cast<const Header*>(file_.data());
+  if (header->magic != kFlatRuleSetsMagic ||
+      header->version != kFlatRuleSetsVersion ||
+      header->entry_count > (length - sizeof(Header)) / sizeof(Entry)) {
+    return false;
+  }
+
+  entries_ = reinterpret_cast<const Entry*>(file_.data() + sizeof(Header));
+  entry_count_ = header->entry_count;
+  for (size_t i = 0; i < entry_count_; ++i) {
+    const Entry& entry = entries_[i];
+    if (entry.key_offset > length ||
+        entry.key_size > length - entry.key_offset ||
+        entry.value_offset > length ||
+        entry.value_size > length - entry.value_offset) {
+      return false;
+    }
+    if (i > 0 && !(KeyAt(i - 1) < KeyAt(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// static
+bool HTTPSEFlatRuleSets::Serialize(
+    std::vector<std::pair<std::string, std::string>> entries,
+    std::string* output) {
+  std::sort(entries.begin(), entries.end());
+
+  size_t data_offset = sizeof(Header) + entries.size() * sizeof(Entry);
+  size_t total_size = data_offset;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (i > 0 && entries[i - 1].first == entries[i].first) {
+      return false;
+    }
+    total_size += entries[i].first.size() + entries[i].second.size();
+  }
+  if (total_size > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+
+  output->clear();
+  output->reserve(total_size);
+  AppendUint32(kFlatRuleSetsMagic, output);
+  AppendUint32(kFlatRuleSetsVersion, output);
+  AppendUint32(entries.size(), output);
+  uint32_t offset = data_offset;
+  for (const auto& entry : entries) {
+    AppendUint32(offset, output);
+    AppendUint32(entry.first.size(), output);
+    offset += entry.first.size();
+    AppendUint32(offset, output);
+    AppendUint32(entry.second.size(), output);
+    offset += entry.second.size();
+  }
+  for (const auto& entry : entries) {
+    output->append(entry.first);
+    output->append(entry.second);
+  }
+  DCHECK_EQ(total_size, output->size());
+  return true;
+}
+
+bool HTTPSEFlatRuleSets::Get(base::StringPiece key,
+                             base::StringPiece* value) const {
+  size_t low = 0;
+  size_t high = entry_count_;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    const int compare = KeyAt(middle).compare(key);
+    if (compare == 0) {
+      *value = Slice(entries_[middle].value_offset,
+                     entries_[middle].value_size);
+      return true;
+    }
+    if (compare < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return false;
+}
+
+base::StringPiece HTTPSEFlatRuleSets::KeyAt(size_t index) const {
+  DCHECK_LT(index, entry_count_);
+  return Slice(entries_[index].key_offset, entries_[index].key_size);
+}
+
+base::StringPiece HTTPSEFlatRuleSets::Slice(uint32_t offset,
+                                            uint32_t size) const {
+  return base::StringPiece(
+      reinterpret_cast<const char*>(file_.data()) + offset, size);
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,73 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_FLAT_RULESETS_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_FLAT_RULESETS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/memory_mapped_file.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+class FilePath;
+}
+
+namespace brave_shields {
+
+// Read-only, memory mapped HTTPS Everywhere ruleset file. It holds the same
+// key/value pairs as the httpse leveldb (reversed domain lookup key to JSON
+// ruleset list) so it can be used directly from the component directory
+// without unzipping or opening a database. Lookups binary search the mapped
+// index and do not allocate.
+//
+// File layout, all integers are uint32_t in host byte order:
+//   header: magic, version, entry count
+//   index:  entry count x {key offset, key size, value offset, value size},
+//           sorted by key
+//   data:   key and value bytes referenced by the index
+class HTTPSEFlatRuleSets {
+ public:
+  ~HTTPSEFlatRuleSets();
+
+  // Maps and validates |path|. Returns nullptr if the file is missing or
+  // malformed.
+  static std::unique_ptr<HTTPSEFlatRuleSets> Load(const base::FilePath& path);
+
+  // Serializes |entries| into the flat file format. Entries do not need to
+  // be sorted; duplicate keys are not allowed.
+  static bool Serialize(
+      std::vector<std::pair<std::string, std::string>> entries,
+      std::string* output);
+
+  // Returns true and points |value| into the mapped file if |key| exists.
+  bool Get(base::StringPiece key, base::StringPiece* value) const;
+
+  size_t size() const { return entry_count_; }
+  base::StringPiece KeyAt(size_t index) const;
+
+ private:
+  struct Entry;
+
+  HTTPSEFlatRuleSets();
+  bool Validate();
+  base::StringPiece Slice(uint32_t offset, uint32_t size) const;
+
+  base::MemoryMappedFile file_;
+  const Entry* entries_;
+  size_t entry_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSEFlatRuleSets);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_FLAT_RULESETS_H_
@@ -0,0 +1,77 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_flat_rulesets.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::HTTPSEFlatRuleSets;
+
+class HTTPSEFlatRuleSetsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("httpse.rulesets");
+  }
+
+  bool WriteFile(const std::string& data) {
+    return base::WriteFile(path_, data.data(), data.size()) ==
+        static_cast<int>(data.size());
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+};
+
+TEST_F(HTTPSEFlatRuleSetsTest, RoundTrip) {
+  std::vector<std::pair<std::string, std::string>> entries = {
+    { "com.example.*", "[{\"r\":[{\"d\":1}]}]" },
+    { "com.brave", "[{\"r\":[{\"d\":1}]}]" },
+    { "org.eff.www", "[]" },
+  };
+  std::string data;
+  ASSERT_TRUE(HTTPSEFlatRuleSets::Serialize(entries, &data));
+  ASSERT_TRUE(WriteFile(data));
+
+  std::unique_ptr<HTTPSEFlatRuleSets> rule_sets =
+      HTTPSEFlatRuleSets::Load(path_);
+  ASSERT_TRUE(rule_sets);
+  EXPECT_EQ(3u, rule_sets->size());
+  for (const auto& entry : entries) {
+    base::StringPiece value;
+    EXPECT_TRUE(rule_sets->Get(entry.first, &value));
+    EXPECT_EQ(entry.second, value);
+  }
+  base::StringPiece value;
+  EXPECT_FALSE(rule_sets->Get("com.example", &value));
+  EXPECT_FALSE(rule_sets->Get("", &value));
+  EXPECT_FALSE(rule_sets->Get("zz", &value));
+}
+
+TEST_F(HTTPSEFlatRuleSetsTest, RejectsDuplicateKeys) {
+  std::string data;
+  EXPECT_FALSE(HTTPSEFlatRuleSets::Serialize(
+      { { "com.brave", "[]" }, { "com.brave", "[]" } }, &data));
+}
+
+TEST_F(HTTPSEFlatRuleSetsTest, RejectsMalformedFiles) {
+  EXPECT_FALSE(HTTPSEFlatRuleSets::Load(path_));
+
+  ASSERT_TRUE(WriteFile("not a ruleset file"));
+  EXPECT_FALSE(HTTPSEFlatRuleSets::Load(path_));
+
+  std::string data;
+  ASSERT_TRUE(HTTPSEFlatRuleSets::Serialize(
+      { { "com.brave", "[{\"r\":[{\"d\":1}]}]" } }, &data));
+  ASSERT_TRUE(WriteFile(data.substr(0, data.size() - 1)));
+  EXPECT_FALSE(HTTPSEFlatRuleSets::Load(path_));
+}
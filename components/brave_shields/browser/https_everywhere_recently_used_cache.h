@@ -2,56 +2,79 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
-#include <unordered_map>
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
 #include <string>
-#include <vector>
-
-template <class T> class RingBuffer
-{
-private:
-    int currentIdx = 0;
-    int count;
-    std::vector<T> data;
-public:
-    RingBuffer(int fixedSize) : count(fixedSize), data(count) {}
-
-    const T& at(int i) {
-        return data[(currentIdx - (i % count) + count) % count];
-    }
 
-    void add(const T& newValue) {
-        currentIdx = (currentIdx + 1) % count;
-        data[currentIdx] = newValue;
-    }
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/trace_event/trace_event.h"
 
-    T oldest() {
-        return data[(currentIdx + 1) % count];
-    }
+// Size-bounded LRU map from a URL spec to a cached value.
+// All methods are thread safe, so the cache can be consulted from the IO
+// thread while the shields task runner fills it.
+template <class T> class HTTPSERecentlyUsedCache {
+ public:
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t size = 0;
+  };
 
-    void clear() {
-        data = std::vector<T>(count);
-    }
-};
+  explicit HTTPSERecentlyUsedCache(size_t size = 1000) : data_(size) {}
 
-template <class T> class HTTPSERecentlyUsedCache
-{
-private:
-    RingBuffer<T> keysByAge;
-public:
-    std::unordered_map<std::string, T> data;
-
-    HTTPSERecentlyUsedCache(unsigned int size = 100) : keysByAge(size) {}
-
-    void add(const std::string& key, const T& value) {
-        std::string old = keysByAge.oldest();
-        if (!old.empty()) {
-            keysByAge.data.erase(old);
-        }
-        keysByAge[key] = value;
+  // Returns true and fills |value| if |key| is cached.
+  bool get(const std::string& key, T* value) {
+    base::AutoLock lock(lock_);
+    auto it = data_.Get(key);
+    if (it == data_.end()) {
+      stats_.misses++;
+      return false;
     }
+    stats_.hits++;
+    *value = it->second;
+    return true;
+  }
 
-    void clear() {
-        data.clear();
-        keysByAge.clear();
+  void add(const std::string& key, const T& value) {
+    base::AutoLock lock(lock_);
+    if (data_.Peek(key) == data_.end() && data_.size() == data_.max_size()) {
+      stats_.evictions++;
     }
+    data_.Put(key, value);
+    TRACE_COUNTER_ID2(TRACE_DISABLED_BY_DEFAULT("brave.shields"),
+                      "HTTPSERecentlyUsedCache", this,
+                      "hits", stats_.hits,
+                      "misses", stats_.misses);
+    TRACE_COUNTER_ID1(TRACE_DISABLED_BY_DEFAULT("brave.shields"),
+                      "HTTPSERecentlyUsedCache.Evictions", this,
+                      stats_.evictions);
+  }
+
+  void clear() {
+    base::AutoLock lock(lock_);
+    data_.Clear();
+  }
+
+  Stats stats() {
+    base::AutoLock lock(lock_);
+    Stats stats = stats_;
+    stats.size = data_.size();
+    return stats;
+  }
+
+ private:
+  base::Lock lock_;
+  base::HashingMRUCache<std::string, T> data_;
+  Stats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERecentlyUsedCache);
 };
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RECENTLY_USED_CACHE_H_
@@ -0,0 +1,159 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/values.h"
+#include "third_party/re2/src/re2/re2.h"
+#include "third_party/re2/src/re2/set.h"
+
+namespace brave_shields {
+
+std::string CorrecttoRuleToRE2Engine(const std::string& to) {
+  std::string correctedto(to);
+  size_t pos = to.find("$");
+  while (std::string::npos != pos) {
+    correctedto[pos] = '\\';
+    pos = correctedto.find("$");
+  }
+
+  return correctedto;
+}
+
+struct HTTPSERuleSet::Rule {
+  // Rules with a "d" key upgrade the scheme only.
+  bool is_default = false;
+  std::unique_ptr<re2::RE2> from;
+  std::string to;
+};
+
+struct HTTPSERuleSet::Target {
+  // All exclusion patterns of the target, fully anchored so that a single
+  // Match() call is equivalent to a FullMatch() against each of them.
+  std::unique_ptr<re2::RE2::Set> exclusions;
+  // A target without a valid "r" list stops rule evaluation.
+  bool has_rules = false;
+  std::vector<Rule> rules;
+};
+
+HTTPSERuleSet::HTTPSERuleSet() {
+}
+
+HTTPSERuleSet::~HTTPSERuleSet() {
+}
+
+// static
+std::unique_ptr<HTTPSERuleSet> HTTPSERuleSet::Create(base::StringPiece json) {
+  std::unique_ptr<base::Value> json_object = base::JSONReader::Read(json);
+  if (nullptr == json_object.get()) {
+    return nullptr;
+  }
+
+  const base::ListValue* topValues = nullptr;
+  json_object->GetAsList(&topValues);
+  if (nullptr == topValues) {
+    return nullptr;
+  }
+
+  std::unique_ptr<HTTPSERuleSet> rule_set(new HTTPSERuleSet());
+  for (size_t i = 0; i < topValues->GetSize(); ++i) {
+    const base::Value* childTopValue = nullptr;
+    if (!topValues->Get(i, &childTopValue)) {
+      continue;
+    }
+    const base::DictionaryValue* childTopDictionary = nullptr;
+    childTopValue->GetAsDictionary(&childTopDictionary);
+    if (nullptr == childTopDictionary) {
+      continue;
+    }
+
+    std::unique_ptr<Target> target = std::make_unique<Target>();
+
+    const base::ListValue* eValues = nullptr;
+    if (childTopDictionary->GetList("e", &eValues)) {
+      auto exclusions = std::make_unique<re2::RE2::Set>(
+          re2::RE2::DefaultOptions, re2::RE2::ANCHOR_BOTH);
+      bool has_exclusions = false;
+      for (size_t j = 0; j < eValues->GetSize(); ++j) {
+        const base::DictionaryValue* pDictionary = nullptr;
+        std::string pattern;
+        if (!eValues->GetDictionary(j, &pDictionary) ||
+            !pDictionary->GetString("p", &pattern)) {
+          continue;
+        }
+        if (exclusions->Add(CorrecttoRuleToRE2Engine(pattern), nullptr) >= 0) {
+          has_exclusions = true;
+        }
+      }
+      if (has_exclusions && exclusions->Compile()) {
+        target->exclusions = std::move(exclusions);
+      }
+    }
+
+    const base::ListValue* rValues = nullptr;
+    if (childTopDictionary->GetList("r", &rValues)) {
+      target->has_rules = true;
+      for (size_t j = 0; j < rValues->GetSize(); ++j) {
+        const base::DictionaryValue* pDictionary = nullptr;
+        if (!rValues->GetDictionary(j, &pDictionary)) {
+          continue;
+        }
+        Rule rule;
+        if (pDictionary->HasKey("d")) {
+          rule.is_default = true;
+          target->rules.push_back(std::move(rule));
+          continue;
+        }
+
+        std::string from, to;
+        if (!pDictionary->GetString("f", &from) ||
+            !pDictionary->GetString("t", &to)) {
+          continue;
+        }
+        rule.from = std::make_unique<re2::RE2>(from);
+        if (!rule.from->ok()) {
+          continue;
+        }
+        rule.to = CorrecttoRuleToRE2Engine(to);
+        target->rules.push_back(std::move(rule));
+      }
+    }
+
+    rule_set->targets_.push_back(std::move(target));
+  }
+
+  return rule_set;
+}
+
+std::string HTTPSERuleSet::Apply(const std::string& original_url) const {
+  for (const auto& target : targets_) {
+    if (target->exclusions &&
+        target->exclusions->Match(original_url, nullptr)) {
+      return "";
+    }
+
+    if (!target->has_rules) {
+      return "";
+    }
+
+    for (const Rule& rule : target->rules) {
+      if (rule.is_default) {
+        std::string newUrl(original_url);
+        return newUrl.insert(4, "s");
+      }
+
+      std::string newUrl(original_url);
+      if (re2::RE2::Replace(&newUrl, *rule.from, rule.to) &&
+          newUrl != original_url) {
+        return newUrl;
+      }
+    }
+  }
+  return "";
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,53 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace re2 {
+class RE2;
+}
+
+namespace brave_shields {
+
+// Converts the "$1" style back references used by HTTPS Everywhere rewrite
+// targets to the "\1" style expected by RE2.
+std::string CorrecttoRuleToRE2Engine(const std::string& to);
+
+// A single HTTPS Everywhere leveldb value (a JSON list of rulesets) with all
+// of its exclusion and rewrite patterns compiled up front, so applying it to
+// a URL costs regex execution only.
+class HTTPSERuleSet {
+ public:
+  ~HTTPSERuleSet();
+
+  // Parses and compiles |json|. Returns nullptr if |json| is not a valid
+  // ruleset list.
+  static std::unique_ptr<HTTPSERuleSet> Create(base::StringPiece json);
+
+  // Returns the rewritten URL for |original_url|, or an empty string if no
+  // rule applies.
+  std::string Apply(const std::string& original_url) const;
+
+ private:
+  struct Rule;
+  struct Target;
+
+  HTTPSERuleSet();
+
+  std::vector<std::unique_ptr<Target>> targets_;
+
+  DISALLOW_COPY_AND_ASSIGN(HTTPSERuleSet);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_HTTPS_EVERYWHERE_RULESET_H_
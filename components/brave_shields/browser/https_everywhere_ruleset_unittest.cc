@@ -0,0 +1,126 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/path_service.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "brave/common/brave_paths.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+#include "third_party/zlib/google/zip.h"
+
+using brave_shields::HTTPSERuleSet;
+
+namespace {
+
+const char kRuleSet[] =
+    "[{\"e\":[{\"p\":\"^http://www\\\\.example\\\\.com/skip\"}],"
+    "\"r\":[{\"f\":\"^http://(www\\\\.)?example\\\\.com/\","
+    "\"t\":\"https://$1example.com/\"}]},"
+    "{\"r\":[{\"d\":1}]}]";
+
+}  // namespace
+
+TEST(HTTPSERuleSetTest, InvalidJSON) {
+  EXPECT_FALSE(HTTPSERuleSet::Create("not json"));
+  EXPECT_FALSE(HTTPSERuleSet::Create("{\"r\":[]}"));
+}
+
+TEST(HTTPSERuleSetTest, CorrectsBackReferences) {
+  EXPECT_EQ("https://\\1example.com/\\2",
+            brave_shields::CorrecttoRuleToRE2Engine(
+                "https://$1example.com/$2"));
+}
+
+TEST(HTTPSERuleSetTest, Apply) {
+  std::unique_ptr<HTTPSERuleSet> rule_set = HTTPSERuleSet::Create(kRuleSet);
+  ASSERT_TRUE(rule_set);
+  EXPECT_EQ("https://www.example.com/page",
+            rule_set->Apply("http://www.example.com/page"));
+  EXPECT_EQ("https://example.com/",
+            rule_set->Apply("http://example.com/"));
+  // Exclusions stop evaluation of the remaining targets.
+  EXPECT_EQ("", rule_set->Apply("http://www.example.com/skip"));
+  // The second target's default rule only upgrades the scheme.
+  EXPECT_EQ("https://other.example.org/",
+            rule_set->Apply("http://other.example.org/"));
+}
+
+// Replays a URL corpus derived from the shipped ruleset keys and checks that
+// applying a ruleset compiled once, as cached rulesets are, gives the same
+// result as parsing and compiling it on every lookup.
+TEST(HTTPSERuleSetTest, ReplayShippedRuleSets) {
+  brave::RegisterPathProvider();
+  base::FilePath test_data_dir;
+  ASSERT_TRUE(base::PathService::Get(brave::DIR_TEST_DATA, &test_data_dir));
+  base::FilePath zip_db_file_path = test_data_dir
+      .AppendASCII("https-everywhere-data").AppendASCII("6.0")
+      .AppendASCII("httpse.leveldb.zip");
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  ASSERT_TRUE(zip::Unzip(zip_db_file_path, temp_dir.GetPath()));
+
+  leveldb::DB* db = nullptr;
+  leveldb::Status status = leveldb::DB::Open(leveldb::Options(),
+      temp_dir.GetPath().AppendASCII("httpse.leveldb").AsUTF8Unsafe(), &db);
+  ASSERT_TRUE(status.ok());
+  std::unique_ptr<leveldb::DB> db_owner(db);
+
+  // Each key is a reversed domain, optionally ending in a wildcard label.
+  std::map<std::string, std::string> rules;
+  std::vector<std::pair<std::string, std::string>> corpus;
+  std::unique_ptr<leveldb::Iterator> it(
+      db->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    std::string key = it->key().ToString();
+    rules[key] = it->value().ToString();
+    std::vector<std::string> labels = base::SplitString(
+        key, ".", base::KEEP_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    std::reverse(labels.begin(), labels.end());
+    if (!labels.empty() && labels.front() == "*") {
+      labels.front() = "www";
+    }
+    corpus.push_back(std::make_pair(key,
+        "http://" + base::JoinString(labels, ".") + "/index.html"));
+  }
+  ASSERT_FALSE(corpus.empty());
+
+  std::map<std::string, std::unique_ptr<HTTPSERuleSet>> compiled;
+  for (const auto& entry : rules) {
+    compiled[entry.first] = HTTPSERuleSet::Create(entry.second);
+  }
+
+  size_t upgraded = 0;
+  for (const auto& lookup : corpus) {
+    std::string expected;
+    std::unique_ptr<HTTPSERuleSet> rule_set =
+        HTTPSERuleSet::Create(rules[lookup.first]);
+    if (rule_set) {
+      expected = rule_set->Apply(lookup.second);
+    }
+    if (!expected.empty()) {
+      upgraded++;
+    }
+
+    // A compiled ruleset is applied to many requests, so apply it twice.
+    const HTTPSERuleSet* cached = compiled[lookup.first].get();
+    EXPECT_EQ(rule_set != nullptr, cached != nullptr) << lookup.first;
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_EQ(expected, cached ? cached->Apply(lookup.second) : "")
+          << lookup.second;
+    }
+  }
+  EXPECT_GT(upgraded, 0u);
+}
@@ -10,23 +10,26 @@
 #include <vector>
 
 #include "base/base_paths.h"
-#include "base/json/json_reader.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/scoped_blocking_call.h"
-#include "base/values.h"
 #include "brave/components/brave_shields/browser/dat_file_util.h"
+#include "brave/components/brave_shields/browser/https_everywhere_flat_rulesets.h"
+#include "brave/components/brave_shields/browser/https_everywhere_ruleset.h"
 #include "chrome/browser/browser_process.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
-#include "third_party/re2/src/re2/re2.h"
 #include "third_party/zlib/google/zip.h"
 
 #define DAT_FILE "httpse.leveldb.zip"
+#define DAT_FLAT_FILE "httpse.rulesets"
 #define DAT_FILE_VERSION "6.0"
 #define HTTPSE_URLS_REDIRECTS_COUNT_QUEUE   1
 #define HTTPSE_URL_MAX_REDIRECTS_COUNT      5
+#define HTTPSE_COMPILED_RULESETS_CACHE_SIZE 1000
+#define HTTPSE_RECENTLY_USED_CACHE_SIZE     5000
+#define HTTPSE_HOST_RULESETS_CACHE_SIZE     5000
 
 namespace {
   std::vector<std::string> Split(const std::string& s, char delim) {
@@ -82,7 +85,11 @@ std::string HTTPSEverywhereService::g_https_everywhere_component_id_(
 std::string HTTPSEverywhereService::g_https_everywhere_component_base64_public_key_(
     kHTTPSEverywhereComponentBase64PublicKey);
 
-HTTPSEverywhereService::HTTPSEverywhereService() : level_db_(nullptr) {
+HTTPSEverywhereService::HTTPSEverywhereService()
+    : recently_used_cache_(HTTPSE_RECENTLY_USED_CACHE_SIZE),
+      host_rulesets_cache_(HTTPSE_HOST_RULESETS_CACHE_SIZE),
+      compiled_rulesets_(HTTPSE_COMPILED_RULESETS_CACHE_SIZE),
+      level_db_(nullptr) {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
 
@@ -105,6 +112,18 @@ bool HTTPSEverywhereService::Init() {
 
 void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // Prefer the flat ruleset file, which is mapped in place and needs neither
+  // extraction nor a database.
+  base::FilePath flat_file_path =
+      install_dir.AppendASCII(DAT_FILE_VERSION).AppendASCII(DAT_FLAT_FILE);
+  std::unique_ptr<HTTPSEFlatRuleSets> flat_rulesets =
+      HTTPSEFlatRuleSets::Load(flat_file_path);
+  if (flat_rulesets) {
+    CloseDatabase();
+    flat_rulesets_ = std::move(flat_rulesets);
+    return;
+  }
+
   base::FilePath zip_db_file_path =
       install_dir.AppendASCII(DAT_FILE_VERSION).AppendASCII(DAT_FILE);
   base::FilePath unzipped_level_db_path = zip_db_file_path.RemoveExtension();
@@ -130,6 +149,30 @@ void HTTPSEverywhereService::InitDB(const base::FilePath& install_dir) {
     CloseDatabase();
     return;
   }
+
+  BuildRuleSetKeysFilter();
+}
+
+void HTTPSEverywhereService::BuildRuleSetKeysFilter() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::vector<std::string> keys;
+  std::unique_ptr<leveldb::Iterator> it(
+      level_db_->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    keys.push_back(it->key().ToString());
+  }
+  if (!it->status().ok()) {
+    // A partial filter would skip rulesets it never saw, so go without one
+    // and query leveldb for every domain.
+    LOG(ERROR) << "Level db iteration error: " << it->status().ToString();
+    ruleset_keys_filter_.Clear();
+    return;
+  }
+
+  ruleset_keys_filter_ = BloomFilter(keys.size());
+  for (const auto& key : keys) {
+    ruleset_keys_filter_.Add(key);
+  }
 }
 
 void HTTPSEverywhereService::OnComponentReady(
@@ -147,18 +190,16 @@ bool HTTPSEverywhereService::GetHTTPSURL(
     const GURL* url, const uint64_t& request_identifier,
     std::string& new_url) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  base::ScopedBlockingCall scoped_blocking_call(
-      base::BlockingType::WILL_BLOCK);
-  if (!IsInitialized() || !level_db_ || url->scheme() == url::kHttpsScheme) {
+  if (!IsInitialized() || (!level_db_ && !flat_rulesets_) ||
+      url->scheme() == url::kHttpsScheme) {
     return false;
   }
   if (!ShouldHTTPSERedirect(request_identifier)) {
     return false;
   }
 
-  if (recently_used_cache_.data.count(url->spec()) > 0) {
+  if (recently_used_cache_.get(url->spec(), &new_url)) {
     AddHTTPSEUrlToRedirectList(request_identifier);
-    new_url = recently_used_cache_.data[url->spec()];
     return true;
   }
 
@@ -169,19 +210,20 @@ bool HTTPSEverywhereService::GetHTTPSURL(
     candidate_url = candidate_url.ReplaceComponents(replacements);
   }
 
-  const std::vector<std::string> domains = ExpandDomainForLookup(candidate_url.host());
-  for (auto domain : domains) {
-    std::string value = leveldbGet(level_db_, domain);
-    if (!value.empty()) {
-      new_url = ApplyHTTPSRule(candidate_url.spec(), value);
+  const std::vector<std::string>& domains =
+      GetRuleSetKeysForHost(candidate_url.host());
+  for (const auto& domain : domains) {
+    const HTTPSERuleSet* rule_set = GetCompiledRuleSet(domain);
+    if (rule_set) {
+      new_url = rule_set->Apply(candidate_url.spec());
       if (0 != new_url.length()) {
-        recently_used_cache_.data[candidate_url.spec()] = new_url;
+        recently_used_cache_.add(candidate_url.spec(), new_url);
         AddHTTPSEUrlToRedirectList(request_identifier);
         return true;
       }
     }
   }
-  recently_used_cache_.data[candidate_url.spec()].clear();
+  recently_used_cache_.add(candidate_url.spec(), std::string());
   return false;
 }
 
@@ -196,9 +238,8 @@ bool HTTPSEverywhereService::GetHTTPSURLFromCacheOnly(
     return false;
   }
 
-  if (recently_used_cache_.data.count(url->spec()) > 0) {
+  if (recently_used_cache_.get(url->spec(), &cached_url)) {
     AddHTTPSEUrlToRedirectList(request_identifier);
-    cached_url = recently_used_cache_.data[url->spec()];
     return true;
   }
   return false;
@@ -246,122 +287,57 @@ void HTTPSEverywhereService::AddHTTPSEUrlToRedirectList(
   }
 }
 
-std::string HTTPSEverywhereService::ApplyHTTPSRule(
-    const std::string& originalUrl,
-    const std::string& rule) {
-  std::unique_ptr<base::Value> json_object = base::JSONReader::Read(rule);
-  if (nullptr == json_object.get()) {
-    return "";
-  }
-
-  const base::ListValue* topValues = nullptr;
-  json_object->GetAsList(&topValues);
-  if (nullptr == topValues) {
-    return "";
+const std::vector<std::string>& HTTPSEverywhereService::GetRuleSetKeysForHost(
+    const std::string& host) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it = host_rulesets_cache_.Get(host);
+  if (it != host_rulesets_cache_.end()) {
+    return it->second;
   }
 
-  for (size_t i = 0; i < topValues->GetSize(); ++i) {
-    const base::Value* childTopValue = nullptr;
-    if (!topValues->Get(i, &childTopValue)) {
+  // Most hosts have no ruleset at all; the filter lets us skip leveldb for
+  // them, and the result is cached per host either way. The flat index is
+  // searched in memory and needs no filter. Without a filter, e.g. if the
+  // keys couldn't all be read, every domain goes to leveldb.
+  std::vector<std::string> keys;
+  for (const auto& domain : ExpandDomainForLookup(host)) {
+    if (!flat_rulesets_ && !ruleset_keys_filter_.empty() &&
+        !ruleset_keys_filter_.MayContain(domain)) {
       continue;
     }
-    const base::DictionaryValue* childTopDictionary = nullptr;
-    childTopValue->GetAsDictionary(&childTopDictionary);
-    if (nullptr == childTopDictionary) {
-      continue;
+    if (GetCompiledRuleSet(domain)) {
+      keys.push_back(domain);
     }
+  }
+  return host_rulesets_cache_.Put(host, std::move(keys))->second;
+}
 
-    const base::Value* exclusion = nullptr;
-    if (childTopDictionary->Get("e", &exclusion)) {
-      const base::ListValue* eValues = nullptr;
-      exclusion->GetAsList(&eValues);
-      if (nullptr != eValues) {
-        for (size_t j = 0; j < eValues->GetSize(); ++j) {
-          const base::Value* pValue = nullptr;
-          if (!eValues->Get(j, &pValue)) {
-            continue;
-          }
-          const base::DictionaryValue* pDictionary = nullptr;
-          pValue->GetAsDictionary(&pDictionary);
-          if (nullptr == pDictionary) {
-            continue;
-          }
-          const base::Value* patternValue = nullptr;
-          if (!pDictionary->Get("p", &patternValue)) {
-            continue;
-          }
-          std::string pattern;
-          if (!patternValue->GetAsString(&pattern)) {
-            continue;
-          }
-          pattern = CorrecttoRuleToRE2Engine(pattern);
-          if (RE2::FullMatch(originalUrl, pattern)) {
-            return "";
-          }
-        }
-      }
-    }
+const HTTPSERuleSet* HTTPSEverywhereService::GetCompiledRuleSet(
+    const std::string& domain) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  auto it = compiled_rulesets_.Get(domain);
+  if (it != compiled_rulesets_.end()) {
+    return it->second.get();
+  }
 
-    const base::Value* rules = nullptr;
-    if (!childTopDictionary->Get("r", &rules)) {
-      return "";
-    }
-    const base::ListValue* rValues = nullptr;
-    rules->GetAsList(&rValues);
-    if (nullptr == rValues) {
-      return "";
+  std::unique_ptr<HTTPSERuleSet> rule_set;
+  if (flat_rulesets_) {
+    base::StringPiece value;
+    if (flat_rulesets_->Get(domain, &value)) {
+      rule_set = HTTPSERuleSet::Create(value);
     }
-
-    for (size_t j = 0; j < rValues->GetSize(); ++j) {
-      const base::Value* pValue = nullptr;
-      if (!rValues->Get(j, &pValue)) {
-        continue;
-      }
-      const base::DictionaryValue* pDictionary = nullptr;
-      pValue->GetAsDictionary(&pDictionary);
-      if (nullptr == pDictionary) {
-        continue;
-      }
-      const base::Value* patternValue = nullptr;
-      if (pDictionary->Get("d", &patternValue)) {
-        std::string newUrl(originalUrl);
-        return newUrl.insert(4, "s");
-      }
-
-      const base::Value* from_value = nullptr;
-      const base::Value* to_value = nullptr;
-      if (!pDictionary->Get("f", &from_value) ||
-          !pDictionary->Get("t", &to_value)) {
-        continue;
-      }
-      std::string from, to;
-      if (!from_value->GetAsString(&from) ||
-          !to_value->GetAsString(&to)) {
-        continue;
-      }
-
-      to = CorrecttoRuleToRE2Engine(to);
-      std::string newUrl(originalUrl);
-      RE2 regExp(from);
-
-      if (RE2::Replace(&newUrl, regExp, to) && newUrl != originalUrl) {
-        return newUrl;
-      }
+  } else {
+    base::ScopedBlockingCall scoped_blocking_call(
+        base::BlockingType::WILL_BLOCK);
+    std::string value = leveldbGet(level_db_, domain);
+    if (!value.empty()) {
+      rule_set = HTTPSERuleSet::Create(value);
     }
   }
-  return "";
-}
-
-std::string HTTPSEverywhereService::CorrecttoRuleToRE2Engine(
-    const std::string& to) {
-  std::string correctedto(to);
-  size_t pos = to.find("$");
-  while (std::string::npos != pos) {
-    correctedto[pos] = '\\';
-    pos = correctedto.find("$");
+  if (!rule_set) {
+    return nullptr;
   }
-
-  return correctedto;
+  return compiled_rulesets_.Put(domain, std::move(rule_set))->second.get();
 }
 
 void HTTPSEverywhereService::CloseDatabase() {
@@ -370,6 +346,11 @@ void HTTPSEverywhereService::CloseDatabase() {
     delete level_db_;
     level_db_ = nullptr;
   }
+  flat_rulesets_.reset();
+  compiled_rulesets_.Clear();
+  host_rulesets_cache_.Clear();
+  ruleset_keys_filter_.Clear();
+  recently_used_cache_.clear();
 }
 
 // static
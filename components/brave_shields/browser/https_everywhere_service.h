@@ -12,9 +12,11 @@
 #include <vector>
 #include <mutex>
 
+#include "base/containers/mru_cache.h"
 #include "base/files/file_path.h"
 #include "base/sequence_checker.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
+#include "brave/components/brave_shields/browser/bloom_filter.h"
 #include "brave/components/brave_shields/browser/https_everywhere_recently_used_cache.h"
 #include "content/public/common/resource_type.h"
 
@@ -26,6 +28,9 @@ class HTTPSEverywhereServiceTest;
 
 namespace brave_shields {
 
+class HTTPSEFlatRuleSets;
+class HTTPSERuleSet;
+
 const std::string kHTTPSEverywhereComponentName("Brave HTTPS Everywhere Updater");
 const std::string kHTTPSEverywhereComponentId("oofiananboodjbbmdelgdommihjbkfag");
 
@@ -68,9 +73,14 @@ class HTTPSEverywhereService : public BaseBraveShieldsService {
 
   void AddHTTPSEUrlToRedirectList(const uint64_t& request_id);
   bool ShouldHTTPSERedirect(const uint64_t& request_id);
-  std::string ApplyHTTPSRule(const std::string& originalUrl,
-      const std::string& rule);
-  std::string CorrecttoRuleToRE2Engine(const std::string& to);
+  // Returns the lookup keys (see ExpandDomainForLookup) under which rulesets
+  // for |host| are stored, in lookup order. Cached per host, including hosts
+  // without any ruleset.
+  const std::vector<std::string>& GetRuleSetKeysForHost(
+      const std::string& host);
+  // Returns the compiled ruleset stored under the |domain| lookup key,
+  // compiling and caching it on first use.
+  const HTTPSERuleSet* GetCompiledRuleSet(const std::string& domain);
 
  private:
   friend class ::HTTPSEverywhereServiceTest;
@@ -85,10 +95,16 @@ class HTTPSEverywhereService : public BaseBraveShieldsService {
   void CloseDatabase();
 
   void InitDB(const base::FilePath& install_dir);
+  void BuildRuleSetKeysFilter();
 
   std::mutex httpse_get_urls_redirects_count_mutex_;
   std::vector<HTTPSE_REDIRECTS_COUNT_ST> httpse_urls_redirects_count_;
   HTTPSERecentlyUsedCache<std::string> recently_used_cache_;
+  base::MRUCache<std::string, std::vector<std::string>> host_rulesets_cache_;
+  base::MRUCache<std::string, std::unique_ptr<HTTPSERuleSet>>
+      compiled_rulesets_;
+  BloomFilter ruleset_keys_filter_;
+  std::unique_ptr<HTTPSEFlatRuleSets> flat_rulesets_;
   leveldb::DB* level_db_;
 
   SEQUENCE_CHECKER(sequence_checker_);
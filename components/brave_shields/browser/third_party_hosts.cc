@@ -0,0 +1,45 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/third_party_hosts.h"
+
+#include <algorithm>
+
+#include "base/strings/string_split.h"
+
+namespace brave_shields {
+
+ThirdPartyHosts::ThirdPartyHosts(base::StringPiece hosts)
+    : hosts_(base::SplitString(hosts, ",", base::TRIM_WHITESPACE,
+                               base::SPLIT_WANT_NONEMPTY)) {
+  std::sort(hosts_.begin(), hosts_.end());
+  hosts_.erase(std::unique(hosts_.begin(), hosts_.end()), hosts_.end());
+}
+
+ThirdPartyHosts::~ThirdPartyHosts() {
+}
+
+bool ThirdPartyHosts::Matches(base::StringPiece host) const {
+  while (!host.empty()) {
+    if (Contains(host)) {
+      return true;
+    }
+    const size_t dot = host.find('.');
+    if (dot == base::StringPiece::npos) {
+      break;
+    }
+    host.remove_prefix(dot + 1);
+  }
+  return false;
+}
+
+bool ThirdPartyHosts::Contains(base::StringPiece host) const {
+  auto it = std::lower_bound(hosts_.begin(), hosts_.end(), host,
+      [](const std::string& a, base::StringPiece b) {
+        return base::StringPiece(a) < b;
+      });
+  return it != hosts_.end() && *it == host;
+}
+
+}  // namespace brave_shields
@@ -0,0 +1,41 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_THIRD_PARTY_HOSTS_H_
+#define BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_THIRD_PARTY_HOSTS_H_
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace brave_shields {
+
+// The hosts a first party host may load even though tracking protection
+// lists them, as returned by CTPParser::findFirstPartyHosts().
+class ThirdPartyHosts {
+ public:
+  // |hosts| is a comma separated list of hosts.
+  explicit ThirdPartyHosts(base::StringPiece hosts);
+  ~ThirdPartyHosts();
+
+  // Returns true if |host| is one of the hosts or a subdomain of one of them.
+  // Does one binary search per label of |host| and never allocates.
+  bool Matches(base::StringPiece host) const;
+
+  size_t size() const { return hosts_.size(); }
+
+ private:
+  bool Contains(base::StringPiece host) const;
+
+  // Sorted.
+  std::vector<std::string> hosts_;
+
+  DISALLOW_COPY_AND_ASSIGN(ThirdPartyHosts);
+};
+
+}  // namespace brave_shields
+
+#endif  // BRAVE_COMPONENTS_BRAVE_SHIELDS_BROWSER_THIRD_PARTY_HOSTS_H_
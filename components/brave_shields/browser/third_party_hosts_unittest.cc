@@ -0,0 +1,26 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/third_party_hosts.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+using brave_shields::ThirdPartyHosts;
+
+TEST(ThirdPartyHostsTest, ParsesCommaSeparatedHosts) {
+  ThirdPartyHosts hosts("twimg.com,twitter.com,,twitter.jp,twitter.com");
+  EXPECT_EQ(3u, hosts.size());
+  EXPECT_FALSE(ThirdPartyHosts("").Matches("twitter.com"));
+}
+
+TEST(ThirdPartyHostsTest, MatchesHostsAndSubdomains) {
+  ThirdPartyHosts hosts("facebook.com,facebook.net,fb.com");
+  EXPECT_TRUE(hosts.Matches("facebook.net"));
+  EXPECT_TRUE(hosts.Matches("connect.facebook.net"));
+  EXPECT_TRUE(hosts.Matches("static.xx.fb.com"));
+  EXPECT_FALSE(hosts.Matches("notfacebook.net"));
+  EXPECT_FALSE(hosts.Matches("facebook.net.example.com"));
+  EXPECT_FALSE(hosts.Matches("net"));
+  EXPECT_FALSE(hosts.Matches(""));
+}
@@ -17,11 +17,12 @@
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/components/brave_shields/browser/ad_block_service.h"
 #include "brave/components/brave_shields/browser/dat_file_util.h"
+#include "brave/components/brave_shields/browser/third_party_hosts.h"
 #include "brave/vendor/tracking-protection/TPParser.h"
 
 #define DAT_FILE "TrackingProtection.dat"
 #define DAT_FILE_VERSION "1"
-#define THIRD_PARTY_HOSTS_CACHE_SIZE 20
+#define THIRD_PARTY_HOSTS_CACHE_SIZE 1000
 
 namespace brave_shields {
 
@@ -31,8 +32,7 @@ std::string TrackingProtectionService::g_tracking_protection_component_base64_pu
     kTrackingProtectionComponentBase64PublicKey);
 
 TrackingProtectionService::TrackingProtectionService()
-  : tracking_protection_client_(new CTPParser()),
-    // See comment in tracking_protection_service.h for white_list_
+  : // See comment in tracking_protection_service.h for white_list_
     white_list_({
       "connect.facebook.net",
       "connect.facebook.com",
@@ -45,8 +45,7 @@ TrackingProtectionService::TrackingProtectionService()
       "syndication.twitter.com",
       "cdn.syndication.twimg.com"
     }),
-    weak_factory_(this) {
-  DETACH_FROM_SEQUENCE(sequence_checker_);
+    third_party_hosts_cache_(THIRD_PARTY_HOSTS_CACHE_SIZE) {
 }
 
 TrackingProtectionService::~TrackingProtectionService() {
@@ -54,40 +53,29 @@ TrackingProtectionService::~TrackingProtectionService() {
 }
 
 void TrackingProtectionService::Cleanup() {
-  tracking_protection_client_.reset();
+  base::AutoLock lock(engine_lock_);
+  engine_ = nullptr;
 }
 
 bool TrackingProtectionService::ShouldStartRequest(const GURL& url,
     content::ResourceType resource_type,
-    const std::string &tab_host) {
-  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  std::string host = url.host();
-  if (!tracking_protection_client_->matchesTracker(
-        tab_host.c_str(), host.c_str())) {
+    const std::string &tab_host,
+    size_t shard) {
+  scoped_refptr<Engine> engine = GetEngine();
+  if (!engine) {
     return true;
   }
 
-  std::vector<std::string> hosts(GetThirdPartyHosts(tab_host));
-  for (size_t i = 0; i < hosts.size(); i++) {
-    if (host == hosts[i] ||
-        host.find((std::string)"." + hosts[i]) != std::string::npos) {
-      return true;
-    }
-    size_t iPos = host.find((std::string)"." + hosts[i]);
-    if (iPos == std::string::npos) {
-      continue;
-    }
-    if (hosts[i].length() + ((std::string)".").length() + iPos ==
-        host.length()) {
-      return true;
-    }
+  std::string host = url.host();
+  if (!engine->client(shard)->matchesTracker(tab_host.c_str(), host.c_str())) {
+    return true;
   }
 
-  if (std::find(white_list_.begin(), white_list_.end(), host) !=
-      white_list_.end()) {
+  if (GetThirdPartyHosts(engine->client(shard), tab_host)->Matches(host)) {
     return true;
   }
-  return false;
+
+  return white_list_.find(host) != white_list_.end();
 }
 
 bool TrackingProtectionService::Init() {
@@ -97,16 +85,22 @@ bool TrackingProtectionService::Init() {
   return true;
 }
 
-void TrackingProtectionService::OnDATFileDataReady() {
-  if (buffer_.empty()) {
-    LOG(ERROR) << "Could not obtain tracking protection data";
+void TrackingProtectionService::LoadDATFileOnTaskRunner(
+    const base::FilePath& dat_file_path) {
+  scoped_refptr<Engine> engine =
+      Engine::Load(dat_file_path, GetMatchingShardCount());
+  if (!engine) {
+    LOG(ERROR) << "Could not load tracking protection data";
     return;
   }
-  tracking_protection_client_.reset(new CTPParser());
-  if (!tracking_protection_client_->deserialize((char*)&buffer_.front())) {
-    tracking_protection_client_.reset();
-    LOG(ERROR) << "Failed to deserialize tracking protection data";
+
+  {
+    base::AutoLock lock(engine_lock_);
+    engine_ = std::move(engine);
   }
+  IncrementDATFileEngineGeneration();
+  base::AutoLock lock(third_party_hosts_lock_);
+  third_party_hosts_cache_.Clear();
 }
 
 void TrackingProtectionService::OnComponentReady(
@@ -116,66 +110,38 @@ void TrackingProtectionService::OnComponentReady(
   base::FilePath dat_file_path =
       install_dir.AppendASCII(DAT_FILE_VERSION).AppendASCII(DAT_FILE);
 
-  GetTaskRunner()->PostTaskAndReply(
+  GetTaskRunner()->PostTask(
       FROM_HERE,
-      base::Bind(&GetDATFileData, dat_file_path, &buffer_),
-      base::Bind(&TrackingProtectionService::OnDATFileDataReady,
-                 weak_factory_.GetWeakPtr()));
+      base::Bind(&TrackingProtectionService::LoadDATFileOnTaskRunner,
+                 base::Unretained(this), dat_file_path));
+}
+
+scoped_refptr<TrackingProtectionService::Engine>
+TrackingProtectionService::GetEngine() {
+  base::AutoLock lock(engine_lock_);
+  return engine_;
 }
 
 // Ported from Android: net/blockers/blockers_worker.cc
-std::vector<std::string>
-TrackingProtectionService::GetThirdPartyHosts(const std::string& base_host) {
+std::shared_ptr<const ThirdPartyHosts>
+TrackingProtectionService::GetThirdPartyHosts(CTPParser* client,
+                                              const std::string& base_host) {
   {
-    std::lock_guard<std::mutex> guard(third_party_hosts_mutex_);
-    std::map<std::string, std::vector<std::string>>::const_iterator iter =
-      third_party_hosts_cache_.find(base_host);
-    if (third_party_hosts_cache_.end() != iter) {
-      if (third_party_base_hosts_.size() != 0
-          && third_party_base_hosts_[third_party_hosts_cache_.size() - 1] !=
-          base_host) {
-        for (size_t i = 0; i < third_party_base_hosts_.size(); i++) {
-          if (third_party_base_hosts_[i] == base_host) {
-            third_party_base_hosts_.erase(third_party_base_hosts_.begin() + i);
-            third_party_base_hosts_.push_back(base_host);
-            break;
-          }
-        }
-      }
-      return iter->second;
-    }
-  }
-
-  char* thirdPartyHosts =
-    tracking_protection_client_->findFirstPartyHosts(base_host.c_str());
-  std::vector<std::string> hosts;
-  if (nullptr != thirdPartyHosts) {
-    std::string strThirdPartyHosts = thirdPartyHosts;
-    size_t iPos = strThirdPartyHosts.find(",");
-    while (iPos != std::string::npos) {
-      std::string thirdParty = strThirdPartyHosts.substr(0, iPos);
-      strThirdPartyHosts = strThirdPartyHosts.substr(iPos + 1);
-      iPos = strThirdPartyHosts.find(",");
-      hosts.push_back(thirdParty);
-    }
-    if (0 != strThirdPartyHosts.length()) {
-      hosts.push_back(strThirdPartyHosts);
+    base::AutoLock lock(third_party_hosts_lock_);
+    auto it = third_party_hosts_cache_.Get(base_host);
+    if (it != third_party_hosts_cache_.end()) {
+      return it->second;
     }
-    delete []thirdPartyHosts;
   }
 
-  {
-    std::lock_guard<std::mutex> guard(third_party_hosts_mutex_);
-    if (third_party_hosts_cache_.size() == THIRD_PARTY_HOSTS_CACHE_SIZE &&
-        third_party_base_hosts_.size() == THIRD_PARTY_HOSTS_CACHE_SIZE) {
-      third_party_hosts_cache_.erase(third_party_base_hosts_[0]);
-      third_party_base_hosts_.erase(third_party_base_hosts_.begin());
-    }
-    third_party_base_hosts_.push_back(base_host);
-    third_party_hosts_cache_.insert(
-        std::pair<std::string, std::vector<std::string>>(base_host, hosts));
-  }
+  char* third_party_hosts = client->findFirstPartyHosts(base_host.c_str());
+  std::shared_ptr<const ThirdPartyHosts> hosts =
+      std::make_shared<ThirdPartyHosts>(
+          third_party_hosts ? third_party_hosts : "");
+  delete []third_party_hosts;
 
+  base::AutoLock lock(third_party_hosts_lock_);
+  third_party_hosts_cache_.Put(base_host, hosts);
   return hosts;
 }
 
@@ -192,6 +158,12 @@ scoped_refptr<base::SequencedTaskRunner> TrackingProtectionService::GetTaskRunne
   return g_brave_browser_process->ad_block_service()->GetTaskRunner();
 }
 
+scoped_refptr<base::SequencedTaskRunner>
+TrackingProtectionService::GetMatchingTaskRunner(size_t shard) {
+  return g_brave_browser_process->ad_block_service()->GetMatchingTaskRunner(
+      shard);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 // The brave shields factory. Using the Brave Shields as a singleton
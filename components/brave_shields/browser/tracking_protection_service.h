@@ -7,24 +7,26 @@
 
 #include <stdint.h>
 
-#include <map>
 #include <memory>
-#include <mutex>
 #include <string>
-#include <vector>
 
+#include "base/containers/flat_set.h"
+#include "base/containers/mru_cache.h"
 #include "base/files/file_path.h"
-#include "base/memory/weak_ptr.h"
-#include "base/sequence_checker.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
 #include "brave/components/brave_shields/browser/base_brave_shields_service.h"
 #include "brave/components/brave_shields/browser/dat_file_util.h"
 #include "content/public/common/resource_type.h"
 
 class CTPParser;
 class TrackingProtectionServiceTest;
+class TrackingProtectionServiceUnitTest;
 
 namespace brave_shields {
 
+class ThirdPartyHosts;
+
 const std::string kTrackingProtectionComponentName("Brave Tracking Protection Updater");
 const std::string kTrackingProtectionComponentId("afalakplffnnnlkncjhbmahjfjhmlkal");
 
@@ -38,6 +40,8 @@ const std::string kTrackingProtectionComponentBase64PublicKey =
     "xQIDAQAB";
 
 // The brave shields service in charge of tracking protection and init.
+// ShouldStartRequest() runs on GetMatchingTaskRunner(), like ad-block
+// matching.
 class TrackingProtectionService : public BaseBraveShieldsService {
  public:
   TrackingProtectionService();
@@ -45,8 +49,11 @@ class TrackingProtectionService : public BaseBraveShieldsService {
 
   bool ShouldStartRequest(const GURL& spec,
     content::ResourceType resource_type,
-    const std::string& tab_host) override;
+    const std::string& tab_host,
+    size_t shard) override;
   scoped_refptr<base::SequencedTaskRunner> GetTaskRunner() override;
+  scoped_refptr<base::SequencedTaskRunner> GetMatchingTaskRunner(
+      size_t shard) override;
 
  protected:
   bool Init() override;
@@ -57,26 +64,32 @@ class TrackingProtectionService : public BaseBraveShieldsService {
 
  private:
   friend class ::TrackingProtectionServiceTest;
+  friend class ::TrackingProtectionServiceUnitTest;
   static std::string g_tracking_protection_component_id_;
   static std::string g_tracking_protection_component_base64_public_key_;
   static void SetComponentIdAndBase64PublicKeyForTest(
       const std::string& component_id,
       const std::string& component_base64_public_key);
 
-  void OnDATFileDataReady();
-  std::vector<std::string> GetThirdPartyHosts(const std::string& base_host);
+  using Engine = DATFileEngine<CTPParser>;
 
-  brave_shields::DATFileDataBuffer buffer_;
+  void LoadDATFileOnTaskRunner(const base::FilePath& dat_file_path);
+  scoped_refptr<Engine> GetEngine();
+  std::shared_ptr<const ThirdPartyHosts> GetThirdPartyHosts(
+      CTPParser* client, const std::string& base_host);
 
-  std::unique_ptr<CTPParser> tracking_protection_client_;
+  // Guards swapping |engine_| only; matching runs on a reference taken
+  // under the lock, without holding it.
+  base::Lock engine_lock_;
+  scoped_refptr<Engine> engine_;
   // TODO: Temporary hack which matches both browser-laptop and Android code
-  std::vector<std::string> white_list_;
-  std::vector<std::string> third_party_base_hosts_;
-  std::map<std::string, std::vector<std::string>> third_party_hosts_cache_;
-  std::mutex third_party_hosts_mutex_;
+  base::flat_set<std::string> white_list_;
+  // Parsed CTPParser::findFirstPartyHosts() results of the current engine,
+  // by first party host.
+  base::HashingMRUCache<std::string, std::shared_ptr<const ThirdPartyHosts>>
+      third_party_hosts_cache_;
+  base::Lock third_party_hosts_lock_;
 
-  SEQUENCE_CHECKER(sequence_checker_);
-  base::WeakPtrFactory<TrackingProtectionService> weak_factory_;
   DISALLOW_COPY_AND_ASSIGN(TrackingProtectionService);
 };
 
@@ -9,6 +9,7 @@
 #include "brave/browser/brave_browser_process_impl.h"
 #include "brave/common/brave_paths.h"
 #include "brave/common/pref_names.h"
+#include "brave/components/brave_shields/browser/brave_shields_web_contents_observer.h"
 #include "brave/components/brave_shields/browser/tracking_protection_service.h"
 #include "chrome/browser/ui/browser.h"
 #include "chrome/browser/extensions/extension_browsertest.h"
@@ -50,6 +51,8 @@ public:
 
   void SetUp() override {
     InitEmbeddedTestServer();
+    brave_shields::BraveShieldsWebContentsObserver::
+        SetBlockedEventBatchingEnabledForTesting(false);
     ExtensionBrowserTest::SetUp();
   }
 
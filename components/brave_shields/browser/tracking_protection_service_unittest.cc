@@ -0,0 +1,153 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "brave/components/brave_shields/browser/tracking_protection_service.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/path_service.h"
+#include "base/test/scoped_task_environment.h"
+#include "brave/common/brave_paths.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace {
+
+struct PageLoad {
+  const char* tab_host;
+  std::vector<const char*> request_urls;
+};
+
+// Third party requests recorded while loading a few popular pages.
+const std::vector<PageLoad>& GetPageLoadTraces() {
+  static const std::vector<PageLoad> traces = {
+    {"www.facebook.com", {
+      "https://static.xx.fbcdn.net/rsrc.php/v3/y4/r/gf6iHxsw8zm.js",
+      "https://connect.facebook.net/en_US/fbevents.js",
+      "https://www.facebook.com/tr/?id=1&ev=PageView",
+      "https://scontent.xx.fbcdn.net/v/t1.0-1/p50x50/1.jpg",
+      "https://pixel.facebook.com/ajax/bz",
+    }},
+    {"twitter.com", {
+      "https://abs.twimg.com/responsive-web/web/main.js",
+      "https://pbs.twimg.com/profile_images/1/normal.jpg",
+      "https://syndication.twitter.com/i/jot",
+      "https://analytics.twitter.com/i/adsct",
+      "https://www.google-analytics.com/analytics.js",
+    }},
+    {"www.cnn.com", {
+      "https://www.google-analytics.com/analytics.js",
+      "https://securepubads.g.doubleclick.net/gpt/pubads_impl.js",
+      "https://b.scorecardresearch.com/beacon.js",
+      "https://static.chartbeat.com/js/chartbeat.js",
+      "https://cdn.taboola.com/libtrc/cnn/loader.js",
+      "https://widgets.outbrain.com/outbrain.js",
+      "https://connect.facebook.net/en_US/sdk.js",
+      "https://platform.twitter.com/widgets.js",
+      "https://ib.adnxs.com/ut/v3/prebid",
+      "https://fastlane.rubiconproject.com/a/api/fastlane.json",
+      "https://static.criteo.net/js/ld/publishertag.js",
+      "https://pixel.quantserve.com/pixel",
+      "https://cdn.cnn.com/cnn/.e/img/3.0/global/misc/cnn-logo.png",
+    }},
+    {"www.youtube.com", {
+      "https://i.ytimg.com/vi/1/hqdefault.jpg",
+      "https://googleads.g.doubleclick.net/pagead/id",
+      "https://static.doubleclick.net/instream/ad_status.js",
+      "https://www.google-analytics.com/analytics.js",
+      "https://tpc.googlesyndication.com/sodar/sodar2.js",
+    }},
+  };
+  return traces;
+}
+
+}  // namespace
+
+class TrackingProtectionServiceUnitTest : public testing::Test {
+ public:
+  TrackingProtectionServiceUnitTest() {}
+  ~TrackingProtectionServiceUnitTest() override {}
+
+  void SetUp() override {
+    brave::RegisterPathProvider();
+    base::FilePath test_data_dir;
+    ASSERT_TRUE(base::PathService::Get(brave::DIR_TEST_DATA, &test_data_dir));
+    service_.reset(new brave_shields::TrackingProtectionService());
+    service_->LoadDATFileOnTaskRunner(test_data_dir
+        .AppendASCII("tracking-protection-data").AppendASCII("1")
+        .AppendASCII("TrackingProtection.dat"));
+    ASSERT_TRUE(service_->GetEngine());
+  }
+
+ protected:
+  bool ShouldStartRequest(const std::string& url,
+                          const std::string& tab_host) {
+    return ShouldStartRequest(url, tab_host, 0);
+  }
+
+  bool ShouldStartRequest(const std::string& url,
+                          const std::string& tab_host,
+                          size_t shard) {
+    return service_->ShouldStartRequest(GURL(url),
+        content::RESOURCE_TYPE_SCRIPT, tab_host, shard);
+  }
+
+  base::test::ScopedTaskEnvironment scoped_task_environment_;
+  std::unique_ptr<brave_shields::TrackingProtectionService> service_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TrackingProtectionServiceUnitTest);
+};
+
+TEST_F(TrackingProtectionServiceUnitTest, AllowsFirstPartyTrackers) {
+  // facebook.net is one of facebook.com's own hosts.
+  EXPECT_TRUE(ShouldStartRequest(
+      "https://connect.facebook.net/en_US/fbevents.js", "www.facebook.com"));
+  // Hosts which aren't trackers are never blocked.
+  EXPECT_TRUE(ShouldStartRequest(
+      "https://cdn.cnn.com/logo.png", "www.cnn.com"));
+}
+
+TEST_F(TrackingProtectionServiceUnitTest, ShardsMakeTheSameDecisions) {
+  // Every matching shard has its own client, deserialized from the same file.
+  const size_t shard_count =
+      brave_shields::BaseBraveShieldsService::GetMatchingShardCount();
+  for (const PageLoad& page : GetPageLoadTraces()) {
+    for (const char* url : page.request_urls) {
+      const bool expected = ShouldStartRequest(url, page.tab_host, 0);
+      for (size_t shard = 1; shard < shard_count; ++shard) {
+        EXPECT_EQ(expected, ShouldStartRequest(url, page.tab_host, shard))
+            << url << " on " << page.tab_host << ", shard " << shard;
+      }
+    }
+  }
+}
+
+// Replays the page load traces twice. The third party hosts of each tab host
+// are parsed on its first lookup and cached, which mustn't change decisions.
+TEST_F(TrackingProtectionServiceUnitTest, ReplayPageLoadTraces) {
+  std::vector<bool> decisions;
+  int blocked = 0;
+  for (const PageLoad& page : GetPageLoadTraces()) {
+    for (const char* url : page.request_urls) {
+      decisions.push_back(ShouldStartRequest(url, page.tab_host));
+      if (!decisions.back()) {
+        blocked++;
+      }
+    }
+  }
+  EXPECT_GT(blocked, 0);
+
+  size_t request = 0;
+  for (const PageLoad& page : GetPageLoadTraces()) {
+    for (const char* url : page.request_urls) {
+      EXPECT_EQ(decisions[request++], ShouldStartRequest(url, page.tab_host))
+          << url << " on " << page.tab_host;
+    }
+  }
+}
@@ -5,7 +5,9 @@
 #include "brave/components/brave_sync/bookmark_order_util.h"
 
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
 
 namespace brave_sync {
 
@@ -27,14 +29,48 @@ std::vector<int> OrderToIntVect(const std::string& s) {
   return vec_int;
 }
 
+namespace {
+
+// Reads the next non-empty "."-separated component of |*s| into |*value|
+// and advances |*s| past it. Returns false when |*s| has no more
+// components. Parses the same way as OrderToIntVect(), without allocating.
+bool NextOrderComponent(base::StringPiece* s, int* value) {
+  while (!s->empty()) {
+    size_t dot = s->find('.');
+    base::StringPiece component = s->substr(0, dot);
+    s->remove_prefix(dot == base::StringPiece::npos ? s->size() : dot + 1);
+
+    component = base::TrimWhitespaceASCII(component, base::TRIM_ALL);
+    if (component.empty())
+      continue;
+    bool b = base::StringToInt(component, value);
+    CHECK(b);
+    CHECK(*value >= 0);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
 bool CompareOrder(const std::string& left, const std::string& right) {
   // Return: true if left <  right
-  // Split each and use C++ stdlib
-  std::vector<int> vec_left = OrderToIntVect(left);
-  std::vector<int> vec_right = OrderToIntVect(right);
-
-  return std::lexicographical_compare(vec_left.begin(), vec_left.end(),
-    vec_right.begin(), vec_right.end());
+  // Compares component by component, like std::lexicographical_compare
+  // on the results of OrderToIntVect()
+  base::StringPiece rest_left(left);
+  base::StringPiece rest_right(right);
+  int value_left = 0;
+  int value_right = 0;
+  while (true) {
+    bool has_left = NextOrderComponent(&rest_left, &value_left);
+    bool has_right = NextOrderComponent(&rest_right, &value_right);
+    if (!has_right)
+      return false;
+    if (!has_left)
+      return true;
+    if (value_left != value_right)
+      return value_left < value_right;
+  }
 }
 
 } // namespace brave_sync
@@ -58,6 +58,12 @@ TEST_F(BookmarkOrderUtilTest, CompareOrder) {
   EXPECT_TRUE(CompareOrder("1.7.0.1", "1.7.1"));
   EXPECT_TRUE(CompareOrder("1.7.0.1", "1.7.0.2"));
   EXPECT_FALSE(CompareOrder("1.7.0.2", "1.7.0.1"));
+
+  // Empty components are skipped, as in OrderToIntVect
+  EXPECT_FALSE(CompareOrder(".5.", "5"));
+  EXPECT_FALSE(CompareOrder("5", ".5."));
+  EXPECT_TRUE(CompareOrder("..", "1"));
+  EXPECT_TRUE(CompareOrder("1..2", "1.3"));
 }
 
 } // namespace brave_sync
@@ -4,6 +4,9 @@
 
 #include "brave/components/brave_sync/client/bookmark_change_processor.h"
 
+#include <algorithm>
+
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "brave/components/brave_sync/bookmark_order_util.h"
 #include "brave/components/brave_sync/jslib_const.h"
@@ -21,26 +24,27 @@
 using bookmarks::BookmarkNode;
 using bookmarks::BookmarkModel;
 
-namespace {
+namespace brave_sync {
 
-class ScopedPauseObserver {
+// Stops observing the model without invalidating the object id index, for
+// changes that BookmarkChangeProcessor makes itself.
+class BookmarkChangeProcessor::ScopedPauseObserver {
  public:
-  ScopedPauseObserver(brave_sync::BookmarkChangeProcessor* processor) :
+  explicit ScopedPauseObserver(BookmarkChangeProcessor* processor) :
       processor_(processor) {
     DCHECK_NE(processor_, nullptr);
-    processor_->Stop();
+    if (processor_->bookmark_model_)
+      processor_->bookmark_model_->RemoveObserver(processor_);
   }
   ~ScopedPauseObserver() {
     processor_->Start();
   }
 
  private:
-  brave_sync::BookmarkChangeProcessor* processor_;  // Not owned
-};
+  BookmarkChangeProcessor* processor_;  // Not owned
 
-}  // namespace
-
-namespace brave_sync {
+  DISALLOW_COPY_AND_ASSIGN(ScopedPauseObserver);
+};
 
 bool IsSyncManagedNode(const bookmarks::BookmarkPermanentNode* node) {
   return node->GetTitledUrlNodeTitle() ==
@@ -102,41 +106,42 @@ void GetPrevObjectId(const bookmarks::BookmarkNode* parent,
     prev_node->GetMetaInfo("object_id", prev_object_id);
 }
 
-const bookmarks::BookmarkNode* FindByObjectId(bookmarks::BookmarkModel* model,
-                                        const std::string& object_id) {
-  ui::TreeNodeIterator<const bookmarks::BookmarkNode>
-      iterator(model->root_node());
-  while (iterator.has_next()) {
-    const bookmarks::BookmarkNode* node = iterator.Next();
-    std::string node_object_id;
-    node->GetMetaInfo("object_id", &node_object_id);
-
-    if (!node_object_id.empty() && object_id == node_object_id)
-      return node;
-  }
-  return nullptr;
+// Times are stored in meta info as integer milliseconds since the epoch.
+// Older versions stored stringified JS time, which is still read.
+std::string TimeToMetaInfo(const base::Time& time) {
+  return base::Int64ToString(time.ToJavaTime());
 }
 
-uint64_t GetIndex(const bookmarks::BookmarkNode* root_node,
-                  const jslib::Bookmark& record) {
-  uint64_t index = 0;
-  ui::TreeNodeIterator<const bookmarks::BookmarkNode> iterator(root_node);
-  while (iterator.has_next()) {
-    const bookmarks::BookmarkNode* node = iterator.Next();
-
-    if (node->parent() != root_node)
-      return index;
+base::Time GetTimeMetaInfo(const bookmarks::BookmarkNode* node,
+                           const std::string& key) {
+  std::string value;
+  if (!node->GetMetaInfo(key, &value) || value.empty())
+    return base::Time();
+  int64_t java_time = 0;
+  if (base::StringToInt64(value, &java_time))
+    return base::Time::FromJavaTime(java_time);
+  double js_time = 0;
+  if (base::StringToDouble(value, &js_time))
+    return base::Time::FromJsTime(js_time);
+  return base::Time();
+}
 
-    std::string node_order;
-    node->GetMetaInfo("order", &node_order);
+bool IsUnsynced(const bookmarks::BookmarkNode* node) {
+  base::Time sync_timestamp = GetTimeMetaInfo(node, "sync_timestamp");
+  if (sync_timestamp.is_null())
+    return true;
 
-    if (!node_order.empty() &&
-        brave_sync::CompareOrder(record.order, node_order))
-      return index;
+  base::Time last_updated_time = GetTimeMetaInfo(node, "last_updated_time");
+  return !last_updated_time.is_null() && last_updated_time > sync_timestamp;
+}
 
-    ++index;
-  }
-  return index;
+// The indices of |node| and its ancestors in their parents, from the root.
+std::vector<int> GetTreePath(const bookmarks::BookmarkNode* node) {
+  std::vector<int> path;
+  for (; node->parent(); node = node->parent())
+    path.push_back(node->parent()->GetIndexOf(node));
+  std::reverse(path.begin(), path.end());
+  return path;
 }
 
 // this should only be called for resolved records we get from the server
@@ -165,32 +170,7 @@ void UpdateNode(bookmarks::BookmarkModel* model,
   // updating the sync_timestamp marks this record as synced
   model->SetNodeMetaInfo(node,
       "sync_timestamp",
-      std::to_string(record->syncTimestamp.ToJsTime()));
-}
-
-const bookmarks::BookmarkNode* FindParent(bookmarks::BookmarkModel* model,
-                                          const jslib::Bookmark& bookmark) {
-  auto* parent_node = FindByObjectId(model, bookmark.parentFolderObjectId);
-
-  if (!parent_node) {
-    if (!bookmark.order.empty() &&
-        bookmark.order.at(0) == '2') {
-      // mobile generated bookmarks go in the mobile folder so they don't
-      // get so we don't get m.xxx.xxx domains in the normal bookmarks
-      parent_node = model->mobile_node();
-    } else if (!bookmark.hideInToolbar) {
-      // this flag is a bit odd, but if the node doesn't have a parent and
-      // hideInToolbar is false, then this bookmark should go in the
-      // toolbar root. We don't care about this flag for records with
-      // a parent id because they will be inserted into the correct
-      // parent folder
-      parent_node = model->bookmark_bar_node();
-    } else {
-      parent_node = model->other_node();
-    }
-  }
-
-  return parent_node;
+      TimeToMetaInfo(record->syncTimestamp));
 }
 
 }  // namespace
@@ -212,7 +192,10 @@ BookmarkChangeProcessor::BookmarkChangeProcessor(
       profile_(profile),
       bookmark_model_(BookmarkModelFactory::GetForBrowserContext(
           Profile::FromBrowserContext(profile))),
-      deleted_node_root_(nullptr) {
+      deleted_node_root_(nullptr),
+      observing_(false),
+      object_id_index_valid_(false),
+      dirty_nodes_complete_(false) {
   DCHECK(sync_client_);
   DCHECK(sync_prefs);
   DCHECK(bookmark_model_);
@@ -224,11 +207,170 @@ BookmarkChangeProcessor::~BookmarkChangeProcessor() {
 
 void BookmarkChangeProcessor::Start() {
   bookmark_model_->AddObserver(this);
+  observing_ = true;
 }
 
 void BookmarkChangeProcessor::Stop() {
   if (bookmark_model_)
     bookmark_model_->RemoveObserver(this);
+  observing_ = false;
+  parsed_orders_.clear();
+  // changes made while stopped are not seen by the index or dirty nodes
+  InvalidateObjectIdIndex();
+  dirty_nodes_.clear();
+  dirty_nodes_complete_ = false;
+}
+
+const bookmarks::BookmarkNode* BookmarkChangeProcessor::FindByObjectId(
+    const std::string& object_id) {
+  if (!object_id_index_valid_)
+    RebuildObjectIdIndex();
+  if (object_id.empty())
+    return nullptr;
+  auto it = object_id_index_.find(object_id);
+  return it == object_id_index_.end() ? nullptr : it->second;
+}
+
+const bookmarks::BookmarkNode* BookmarkChangeProcessor::FindParent(
+    const jslib::Bookmark& bookmark) {
+  auto* parent_node = FindByObjectId(bookmark.parentFolderObjectId);
+
+  if (!parent_node) {
+    if (!bookmark.order.empty() &&
+        bookmark.order.at(0) == '2') {
+      // mobile generated bookmarks go in the mobile folder so they don't
+      // get so we don't get m.xxx.xxx domains in the normal bookmarks
+      parent_node = bookmark_model_->mobile_node();
+    } else if (!bookmark.hideInToolbar) {
+      // this flag is a bit odd, but if the node doesn't have a parent and
+      // hideInToolbar is false, then this bookmark should go in the
+      // toolbar root. We don't care about this flag for records with
+      // a parent id because they will be inserted into the correct
+      // parent folder
+      parent_node = bookmark_model_->bookmark_bar_node();
+    } else {
+      parent_node = bookmark_model_->other_node();
+    }
+  }
+
+  return parent_node;
+}
+
+void BookmarkChangeProcessor::RebuildObjectIdIndex() {
+  InvalidateObjectIdIndex();
+  // the first node in tree order wins if an object id is not unique
+  ui::TreeNodeIterator<const bookmarks::BookmarkNode>
+      iterator(bookmark_model_->root_node());
+  while (iterator.has_next()) {
+    const bookmarks::BookmarkNode* node = iterator.Next();
+    std::string object_id;
+    node->GetMetaInfo("object_id", &object_id);
+    if (!object_id.empty() &&
+        object_id_index_.insert(std::make_pair(object_id, node)).second)
+      node_object_ids_[node] = object_id;
+  }
+  object_id_index_valid_ = true;
+}
+
+void BookmarkChangeProcessor::IndexObjectId(const BookmarkNode* node) {
+  if (!object_id_index_valid_)
+    return;
+  std::string object_id;
+  node->GetMetaInfo("object_id", &object_id);
+
+  auto old = node_object_ids_.find(node);
+  if (old != node_object_ids_.end()) {
+    if (old->second == object_id)
+      return;
+    object_id_index_.erase(old->second);
+    node_object_ids_.erase(old);
+  }
+  if (object_id.empty())
+    return;
+
+  auto replaced = object_id_index_.find(object_id);
+  if (replaced != object_id_index_.end())
+    node_object_ids_.erase(replaced->second);
+  object_id_index_[object_id] = node;
+  node_object_ids_[node] = object_id;
+}
+
+void BookmarkChangeProcessor::AddToObjectIdIndex(const BookmarkNode* node) {
+  IndexObjectId(node);
+  ui::TreeNodeIterator<const bookmarks::BookmarkNode> iterator(node);
+  while (iterator.has_next())
+    IndexObjectId(iterator.Next());
+}
+
+void BookmarkChangeProcessor::ForgetNode(const BookmarkNode* node) {
+  auto forget = [this](const BookmarkNode* node) {
+    auto it = node_object_ids_.find(node);
+    if (it != node_object_ids_.end()) {
+      object_id_index_.erase(it->second);
+      node_object_ids_.erase(it);
+    }
+    parsed_orders_.erase(node);
+    dirty_nodes_.erase(node);
+  };
+  forget(node);
+  ui::TreeNodeIterator<const bookmarks::BookmarkNode> iterator(node);
+  while (iterator.has_next())
+    forget(iterator.Next());
+}
+
+void BookmarkChangeProcessor::InvalidateObjectIdIndex() {
+  object_id_index_.clear();
+  node_object_ids_.clear();
+  object_id_index_valid_ = false;
+}
+
+int BookmarkChangeProcessor::GetIndex(const bookmarks::BookmarkNode* parent,
+                                      const jslib::Bookmark& record) {
+  // Inserts before the first child with an order greater than the record's.
+  // Children are kept sorted by order, so this is a binary search; children
+  // without an order are skipped over.
+  const std::vector<int> order = OrderToIntVect(record.order);
+  int low = 0;
+  int high = parent->child_count();
+  int index = high;
+  while (low < high) {
+    int mid = low + (high - low) / 2;
+    // the first child with an order at or after |mid|
+    int child = mid;
+    const std::vector<int>* child_order = nullptr;
+    while (child < high &&
+           !(child_order = GetParsedOrder(parent->GetChild(child))))
+      ++child;
+
+    if (!child_order) {
+      high = mid;
+    } else if (std::lexicographical_compare(order.begin(), order.end(),
+                                            child_order->begin(),
+                                            child_order->end())) {
+      index = child;
+      high = mid;
+    } else {
+      low = child + 1;
+    }
+  }
+  return index;
+}
+
+const std::vector<int>* BookmarkChangeProcessor::GetParsedOrder(
+    const bookmarks::BookmarkNode* node) {
+  const BookmarkNode::MetaInfoMap* meta_info = node->GetMetaInfoMap();
+  if (!meta_info)
+    return nullptr;
+  auto order = meta_info->find("order");
+  if (order == meta_info->end() || order->second.empty())
+    return nullptr;
+
+  auto& parsed = parsed_orders_[node];
+  if (parsed.first != order->second) {
+    parsed.first = order->second;
+    parsed.second = OrderToIntVect(order->second);
+  }
+  return &parsed.second;
 }
 
 void BookmarkChangeProcessor::BookmarkModelLoaded(BookmarkModel* model,
@@ -238,12 +380,19 @@ void BookmarkChangeProcessor::BookmarkModelLoaded(BookmarkModel* model,
 
 void BookmarkChangeProcessor::BookmarkModelBeingDeleted(bookmarks::BookmarkModel* model) {
   NOTREACHED();
+  InvalidateObjectIdIndex();
+  parsed_orders_.clear();
+  dirty_nodes_.clear();
   bookmark_model_ = nullptr;
 }
 
 void BookmarkChangeProcessor::BookmarkNodeAdded(BookmarkModel* model,
                                                 const BookmarkNode* parent,
                                                 int index) {
+  // added nodes may already have sync meta info, e.g. when a removal is
+  // undone
+  AddToObjectIdIndex(parent->GetChild(index));
+  MarkDirty(parent->GetChild(index));
 }
 
 void BookmarkChangeProcessor::OnWillRemoveBookmarks(BookmarkModel* model,
@@ -279,6 +428,7 @@ void BookmarkChangeProcessor::CloneBookmarkNodeForDeleteImpl(
 
   auto* cloned_node_ptr = cloned_node.get();
   parent->Add(std::move(cloned_node), index);
+  IndexObjectId(cloned_node_ptr);
   // we call `Changed` here because we don't want to update the order
   BookmarkNodeChanged(bookmark_model_, cloned_node_ptr);
 }
@@ -299,6 +449,7 @@ void BookmarkChangeProcessor::BookmarkNodeRemoved(
     int old_index,
     const BookmarkNode* node,
     const std::set<GURL>& no_longer_bookmarked) {
+  ForgetNode(node);
   // TODO(bridiver) - should this be in OnWillRemoveBookmarks?
   // copy into the deleted node tree without firing any events
   auto* deleted_node = GetDeletedNodeRoot();
@@ -313,11 +464,16 @@ void BookmarkChangeProcessor::BookmarkAllUserNodesRemoved(
     const std::set<GURL>& removed_urls) {
   // this only happens on profile deletion and we don't want
   // to wipe out the remote store when that happens
+  InvalidateObjectIdIndex();
+  parsed_orders_.clear();
+  dirty_nodes_.clear();
+  dirty_nodes_complete_ = false;
 }
 
 void BookmarkChangeProcessor::BookmarkNodeChanged(BookmarkModel* model,
                                                   const BookmarkNode* node) {
   ScopedPauseObserver pause(this);
+  dirty_nodes_.insert(node);
   // clearing the sync_timestamp will put the record back in the `Unsynced` list
   model->DeleteNodeMetaInfo(node, "sync_timestamp");
   // also clear the last send time because this is a new change
@@ -325,11 +481,12 @@ void BookmarkChangeProcessor::BookmarkNodeChanged(BookmarkModel* model,
 
   model->SetNodeMetaInfo(node,
       "last_updated_time",
-      std::to_string(base::Time::Now().ToJsTime()));
+      TimeToMetaInfo(base::Time::Now()));
 }
 
 void BookmarkChangeProcessor::BookmarkMetaInfoChanged(
     BookmarkModel* model, const BookmarkNode* node) {
+  IndexObjectId(node);
   BookmarkNodeChanged(model, node);
 }
 
@@ -337,6 +494,7 @@ void BookmarkChangeProcessor::BookmarkNodeMoved(BookmarkModel* model,
       const BookmarkNode* old_parent, int old_index,
       const BookmarkNode* new_parent, int new_index) {
   auto* node = new_parent->GetChild(new_index);
+  dirty_nodes_.insert(node);
   model->DeleteNodeMetaInfo(node, "order");
   // TODO(darkdh): handle old_parent == new_parent to avoid duplicate order
   // clearing. Also https://github.com/brave/sync/issues/231 blocks update to
@@ -384,6 +542,11 @@ void BookmarkChangeProcessor::Reset() {
   auto* deleted_node = GetDeletedNodeRoot();
   CHECK(deleted_node);
   deleted_node->DeleteAll();
+  InvalidateObjectIdIndex();
+  parsed_orders_.clear();
+  // every node is unsynced now
+  dirty_nodes_.clear();
+  dirty_nodes_complete_ = false;
   bookmark_model_->EndExtensiveChanges();
 }
 
@@ -394,27 +557,30 @@ void BookmarkChangeProcessor::DeleteSelfAndChildren(
     if (node->GetChild(i)->is_folder()) {
       DeleteSelfAndChildren(node->GetChild(i));
     } else {
+      ForgetNode(node->GetChild(i));
       bookmark_model_->Remove(node->GetChild(i));
     }
   }
+  ForgetNode(node);
   bookmark_model_->Remove(node);
 }
 
 void BookmarkChangeProcessor::ApplyChangesFromSyncModel(
     const RecordsList &records) {
   ScopedPauseObserver pause(this);
+  // without observing the model, changes since the last batch are unknown
+  if (!observing_)
+    InvalidateObjectIdIndex();
   bookmark_model_->BeginExtensiveChanges();
   for (const auto& sync_record : records) {
     DCHECK(sync_record->has_bookmark());
     DCHECK(!sync_record->objectId.empty());
 
-    auto* node = FindByObjectId(bookmark_model_, sync_record->objectId);
+    auto* node = FindByObjectId(sync_record->objectId);
     auto bookmark_record = sync_record->GetBookmark();
 
     if (node && sync_record->action == jslib::SyncRecord::Action::A_UPDATE) {
-      int64_t old_parent_local_id = node->parent()->id();
-      const bookmarks::BookmarkNode* old_parent_node =
-          bookmarks::GetBookmarkNodeByID(bookmark_model_, old_parent_local_id);
+      const bookmarks::BookmarkNode* old_parent_node = node->parent();
 
       std::string old_parent_object_id;
       if (old_parent_node) {
@@ -423,7 +589,7 @@ void BookmarkChangeProcessor::ApplyChangesFromSyncModel(
 
       const bookmarks::BookmarkNode* new_parent_node = nullptr;
       if (bookmark_record.parentFolderObjectId != old_parent_object_id) {
-        new_parent_node = FindParent(bookmark_model_, bookmark_record);
+        new_parent_node = FindParent(bookmark_record);
       }
 
       if (new_parent_node) {
@@ -432,17 +598,20 @@ void BookmarkChangeProcessor::ApplyChangesFromSyncModel(
         bookmark_model_->Move(node, new_parent_node, index);
       }
       UpdateNode(bookmark_model_, node, sync_record.get());
+      IndexObjectId(node);
     } else if (node &&
                sync_record->action == jslib::SyncRecord::Action::A_DELETE) {
       if (node->parent() == GetDeletedNodeRoot()) {
         // this is a deleted node so remove without firing events
         int index = GetDeletedNodeRoot()->GetIndexOf(node);
+        ForgetNode(node);
         GetDeletedNodeRoot()->Remove(index);
       } else {
         // normal remove
         if (node->is_folder()) {
           DeleteSelfAndChildren(node);
         } else {
+          ForgetNode(node);
           bookmark_model_->Remove(node);
         }
       }
@@ -450,7 +619,7 @@ void BookmarkChangeProcessor::ApplyChangesFromSyncModel(
       if (!node) {
         // TODO(bridiver) make sure there isn't an existing record for objectId
         const bookmarks::BookmarkNode* parent_node =
-            FindParent(bookmark_model_, bookmark_record);
+            FindParent(bookmark_record);
 
         const BookmarkNode* bookmark_bar = bookmark_model_->bookmark_bar_node();
         bool bookmark_bar_was_empty = bookmark_bar->empty();
@@ -470,6 +639,7 @@ void BookmarkChangeProcessor::ApplyChangesFromSyncModel(
                                           true);
       }
       UpdateNode(bookmark_model_, node, sync_record.get());
+      IndexObjectId(node);
     }
   }
   bookmark_model_->EndExtensiveChanges();
@@ -524,20 +694,16 @@ BookmarkChangeProcessor::BookmarkNodeToSyncBookmark(
 
   auto* deleted_node = GetDeletedNodeRoot();
   CHECK(deleted_node);
-  std::string sync_timestamp;
-  node->GetMetaInfo("sync_timestamp", &sync_timestamp);
-
-  if (!sync_timestamp.empty()) {
-    record->syncTimestamp = base::Time::FromJsTime(std::stod(sync_timestamp));
-  } else {
+  record->syncTimestamp = GetTimeMetaInfo(node, "sync_timestamp");
+  if (record->syncTimestamp.is_null())
     record->syncTimestamp = base::Time::Now();
-  }
 
   if (record->objectId.empty()) {
     ScopedPauseObserver pause(this);
     record->objectId = tools::GenerateObjectId();
     record->action = jslib::SyncRecord::Action::A_CREATE;
     bookmark_model_->SetNodeMetaInfo(node, "object_id", record->objectId);
+    IndexObjectId(node);
   } else if (node->HasAncestor(deleted_node)) {
     record->action = jslib::SyncRecord::Action::A_DELETE;
   } else {
@@ -550,28 +716,16 @@ BookmarkChangeProcessor::BookmarkNodeToSyncBookmark(
   return record;
 }
 
-bool IsUnsynced(const bookmarks::BookmarkNode* node) {
-  std::string sync_timestamp;
-  node->GetMetaInfo("sync_timestamp", &sync_timestamp);
-
-  if (sync_timestamp.empty())
-    return true;
-
-  std::string last_updated_time;
-  node->GetMetaInfo("last_updated_time", &last_updated_time);
-
-  return !last_updated_time.empty() &&
-      base::Time::FromJsTime(std::stod(last_updated_time)) >
-      base::Time::FromJsTime(std::stod(sync_timestamp));
-}
-
 void BookmarkChangeProcessor::GetAllSyncData(
     const std::vector<std::unique_ptr<jslib::SyncRecord>>& records,
     SyncRecordAndExistingList* records_and_existing_objects) {
+  // without observing the model, changes since the last batch are unknown
+  if (!observing_)
+    InvalidateObjectIdIndex();
   for (const auto& record : records) {
     auto resolved_record = std::make_unique<SyncRecordAndExisting>();
     resolved_record->first = jslib::SyncRecord::Clone(*record);
-    auto* node = FindByObjectId(bookmark_model_, record->objectId);
+    auto* node = FindByObjectId(record->objectId);
     if (node) {
       // only match unsynced nodes so we don't accidentally overwrite
       // changes from another client with our local changes
@@ -605,10 +759,15 @@ bookmarks::BookmarkNode* BookmarkChangeProcessor::GetDeletedNodeRoot() {
   return deleted_node_root_;
 }
 
-void BookmarkChangeProcessor::SendUnsynced(
-    base::TimeDelta unsynced_send_interval) {
-  std::vector<std::unique_ptr<jslib::SyncRecord>> records;
+void BookmarkChangeProcessor::MarkDirty(const BookmarkNode* node) {
+  dirty_nodes_.insert(node);
+  ui::TreeNodeIterator<const bookmarks::BookmarkNode> iterator(node);
+  while (iterator.has_next())
+    dirty_nodes_.insert(iterator.Next());
+}
 
+std::vector<const bookmarks::BookmarkNode*>
+BookmarkChangeProcessor::GetDirtyNodes() {
   auto* deleted_node = GetDeletedNodeRoot();
   CHECK(deleted_node);
   std::vector<const bookmarks::BookmarkNode*> root_nodes = {
@@ -617,40 +776,74 @@ void BookmarkChangeProcessor::SendUnsynced(
     deleted_node
   };
 
-  for (const auto* root_node : root_nodes) {
-    ui::TreeNodeIterator<const bookmarks::BookmarkNode>
-        iterator(root_node);
-    while (iterator.has_next()) {
-      const bookmarks::BookmarkNode* node = iterator.Next();
-
-      // only send unsynced records
-      if (!IsUnsynced(node))
-        continue;
-
-      std::string last_send_time;
-      node->GetMetaInfo("last_send_time", &last_send_time);
-      if (!last_send_time.empty() &&
-          // don't send more often than unsynced_send_interval_
-          (base::Time::Now() -
-              base::Time::FromJsTime(std::stod(last_send_time))) <
-          unsynced_send_interval)
-        continue;
-
-      {
-        ScopedPauseObserver pause(this);
-        bookmark_model_->SetNodeMetaInfo(node,
-            "last_send_time", std::to_string(base::Time::Now().ToJsTime()));
-      }
-      auto record = BookmarkNodeToSyncBookmark(node);
-      if (record)
-        records.push_back(std::move(record));
-
-      if (records.size() == 1000) {
-        sync_client_->SendSyncRecords(
-            jslib_const::SyncRecordType_BOOKMARKS, records);
-        records.clear();
+  if (!dirty_nodes_complete_) {
+    dirty_nodes_.clear();
+    for (const auto* root_node : root_nodes) {
+      ui::TreeNodeIterator<const bookmarks::BookmarkNode>
+          iterator(root_node);
+      while (iterator.has_next()) {
+        const bookmarks::BookmarkNode* node = iterator.Next();
+        if (IsUnsynced(node))
+          dirty_nodes_.insert(node);
       }
     }
+    dirty_nodes_complete_ = true;
+  }
+
+  // nodes are sent in tree order so parents get an object id before their
+  // children
+  std::vector<std::pair<std::vector<int>, const bookmarks::BookmarkNode*>>
+      sorted_nodes;
+  for (auto it = dirty_nodes_.begin(); it != dirty_nodes_.end();) {
+    const bookmarks::BookmarkNode* node = *it;
+    bool under_root_node = std::any_of(
+        root_nodes.begin(), root_nodes.end(),
+        [node](const bookmarks::BookmarkNode* root_node) {
+          return node != root_node && node->HasAncestor(root_node);
+        });
+    // synced nodes are clean until they change again
+    if (!under_root_node || !IsUnsynced(node)) {
+      it = dirty_nodes_.erase(it);
+      continue;
+    }
+    sorted_nodes.push_back(std::make_pair(GetTreePath(node), node));
+    ++it;
+  }
+  std::sort(sorted_nodes.begin(), sorted_nodes.end());
+
+  std::vector<const bookmarks::BookmarkNode*> nodes;
+  nodes.reserve(sorted_nodes.size());
+  for (const auto& sorted_node : sorted_nodes)
+    nodes.push_back(sorted_node.second);
+  return nodes;
+}
+
+void BookmarkChangeProcessor::SendUnsynced(
+    base::TimeDelta unsynced_send_interval) {
+  std::vector<std::unique_ptr<jslib::SyncRecord>> records;
+
+  // only send unsynced records
+  for (const auto* node : GetDirtyNodes()) {
+    base::Time last_send_time = GetTimeMetaInfo(node, "last_send_time");
+    if (!last_send_time.is_null() &&
+        // don't send more often than unsynced_send_interval_
+        (base::Time::Now() - last_send_time) < unsynced_send_interval)
+      continue;
+
+    {
+      ScopedPauseObserver pause(this);
+      bookmark_model_->SetNodeMetaInfo(node,
+          "last_send_time", TimeToMetaInfo(base::Time::Now()));
+    }
+    auto record = BookmarkNodeToSyncBookmark(node);
+    if (record)
+      records.push_back(std::move(record));
+
+    if (records.size() == 1000) {
+      sync_client_->SendSyncRecords(
+          jslib_const::SyncRecordType_BOOKMARKS, records);
+      records.clear();
+    }
   }
   if (!records.empty()) {
     sync_client_->SendSyncRecords(
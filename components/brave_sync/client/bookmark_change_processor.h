@@ -6,6 +6,10 @@
 #define BRAVE_COMPONENTS_BRAVE_SYNC_CLIENT_BOOKMARKS_BOOKMARK_CHANGE_PROCESSOR_H_
 
 #include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "base/compiler_specific.h"
 #include "base/macros.h"
@@ -40,6 +44,8 @@ class BookmarkChangeProcessor : public ChangeProcessor,
   void InitialSync() override;
 
  private:
+  class ScopedPauseObserver;
+
   BookmarkChangeProcessor(Profile* profile,
                           BraveSyncClient* sync_client,
                           prefs::Prefs* sync_prefs);
@@ -77,6 +83,11 @@ class BookmarkChangeProcessor : public ChangeProcessor,
       bookmarks::BookmarkModel* model,
       const bookmarks::BookmarkNode* node) override;
 
+  // Adds |node| and its descendants to |dirty_nodes_|.
+  void MarkDirty(const bookmarks::BookmarkNode* node);
+  // Returns the nodes SendUnsynced() may send, parents before children.
+  std::vector<const bookmarks::BookmarkNode*> GetDirtyNodes();
+
   std::unique_ptr<jslib::SyncRecord> BookmarkNodeToSyncBookmark(
       const bookmarks::BookmarkNode* node);
   bookmarks::BookmarkNode* GetDeletedNodeRoot();
@@ -92,6 +103,25 @@ class BookmarkChangeProcessor : public ChangeProcessor,
   // "Other Bookmarks" so we need to explicitly delete children
   void DeleteSelfAndChildren(const bookmarks::BookmarkNode* node);
 
+  // Returns the node with the "object_id" meta info |object_id|, if any.
+  const bookmarks::BookmarkNode* FindByObjectId(const std::string& object_id);
+  const bookmarks::BookmarkNode* FindParent(const jslib::Bookmark& bookmark);
+  void RebuildObjectIdIndex();
+  // Updates |object_id_index_| for the "object_id" meta info of |node|.
+  void IndexObjectId(const bookmarks::BookmarkNode* node);
+  // Adds |node| and its descendants to |object_id_index_|.
+  void AddToObjectIdIndex(const bookmarks::BookmarkNode* node);
+  // Drops |node| and its descendants, which are about to be deleted, from
+  // the object id index and all other per-node state.
+  void ForgetNode(const bookmarks::BookmarkNode* node);
+  void InvalidateObjectIdIndex();
+  // Returns the position among the children of |parent| at which a node for
+  // |record| should be inserted to keep the children sorted by order.
+  int GetIndex(const bookmarks::BookmarkNode* parent,
+               const jslib::Bookmark& record);
+  // Returns the parsed "order" meta info of |node|, or null if it has none.
+  const std::vector<int>* GetParsedOrder(const bookmarks::BookmarkNode* node);
+
   BraveSyncClient* sync_client_;  // not owned
   prefs::Prefs* sync_prefs_;  // not owned
   Profile* profile_; // not owned
@@ -99,6 +129,30 @@ class BookmarkChangeProcessor : public ChangeProcessor,
 
   bookmarks::BookmarkNode* deleted_node_root_;
 
+  // Whether Start() was called more recently than Stop(). Changes made while
+  // the observer is paused by ScopedPauseObserver are made by this class,
+  // which keeps the index up to date itself.
+  bool observing_;
+  // Nodes by "object_id" meta info, and the other way around. Only valid
+  // while |object_id_index_valid_|.
+  std::unordered_map<std::string, const bookmarks::BookmarkNode*>
+      object_id_index_;
+  std::unordered_map<const bookmarks::BookmarkNode*, std::string>
+      node_object_ids_;
+  bool object_id_index_valid_;
+  // "order" meta info and its OrderToIntVect() result, by node. An entry is
+  // reparsed when the meta info no longer matches, and dropped by
+  // ForgetNode() when its node is removed.
+  std::unordered_map<const bookmarks::BookmarkNode*,
+                     std::pair<std::string, std::vector<int>>>
+      parsed_orders_;
+  // Nodes changed since they were last found synced, a superset of the
+  // unsynced nodes. The sync meta info persists which nodes are unsynced;
+  // this is rebuilt from it by one full scan in SendUnsynced() when not
+  // |dirty_nodes_complete_|, e.g. after a restart or Stop().
+  std::unordered_set<const bookmarks::BookmarkNode*> dirty_nodes_;
+  bool dirty_nodes_complete_;
+
   DISALLOW_COPY_AND_ASSIGN(BookmarkChangeProcessor);
 };
 
@@ -4,6 +4,7 @@
 
 #include "base/files/scoped_temp_dir.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
 #include "brave/components/brave_sync/client/bookmark_change_processor.h"
 #include "brave/components/brave_sync/client/brave_sync_client_impl.h"
 #include "brave/components/brave_sync/client/client_ext_impl_data.h"
@@ -43,7 +44,7 @@
 // BookmarkModelLoaded         | N/A
 // BookmarkModelBeingDeleted   | N/A
 // BookmarkNodeMoved           | +
-// BookmarkNodeAdded           | N/A
+// BookmarkNodeAdded           | +
 // OnWillRemoveBookmarks       | N/A
 // BookmarkNodeRemoved         | +
 // BookmarkAllUserNodesRemoved | N/A
@@ -314,6 +315,38 @@ TEST_F(BraveBookmarkChangeProcessorTest, BookmarkModified) {
   change_processor()->SendUnsynced(base::TimeDelta::FromMinutes(10));
 }
 
+TEST_F(BraveBookmarkChangeProcessorTest, SendUnsyncedFromStoredMetaInfo) {
+  // Nodes changed before the processor started, e.g. in a previous session,
+  // are found from their meta info. Times stored by older versions as JS
+  // time are still understood.
+  const auto* node_a = model()->AddURL(model()->other_node(), 0,
+                                       base::ASCIIToUTF16("A.com - title"),
+                                       GURL("https://a.com/"));
+  model()->SetNodeMetaInfo(node_a, "object_id", "1, 2, 3");
+  model()->SetNodeMetaInfo(node_a, "sync_timestamp", "1539000000000.500000");
+  model()->SetNodeMetaInfo(node_a, "last_updated_time", "1539000000001");
+
+  const auto* node_b = model()->AddURL(model()->other_node(), 1,
+                                       base::ASCIIToUTF16("B.com - title"),
+                                       GURL("https://b.com/"));
+  model()->SetNodeMetaInfo(node_b, "object_id", "4, 5, 6");
+  model()->SetNodeMetaInfo(node_b, "sync_timestamp", "1539000000001");
+  model()->SetNodeMetaInfo(node_b, "last_updated_time",
+                           "1539000000000.500000");
+
+  change_processor()->Start();
+
+  using brave_sync::jslib::SyncRecord;
+  EXPECT_CALL(*sync_client(), SendSyncRecords("BOOKMARKS", testing::AllOf(
+      ContainsRecord(SyncRecord::Action::A_UPDATE, "https://a.com/"),
+      RecordsNumber(1)))).Times(1);
+  change_processor()->SendUnsynced(base::TimeDelta::FromMinutes(10));
+
+  // nothing changed since, and a.com was sent too recently to resend
+  EXPECT_CALL(*sync_client(), SendSyncRecords("BOOKMARKS", _)).Times(0);
+  change_processor()->SendUnsynced(base::TimeDelta::FromMinutes(10));
+}
+
 TEST_F(BraveBookmarkChangeProcessorTest, BookmarkMovedInFolder) {
   change_processor()->Start();
 
@@ -780,3 +813,128 @@ TEST_F(BraveBookmarkChangeProcessorTest, TitleCustomTitle) {
   const auto* folder2 = folder1->GetChild(0);
   EXPECT_EQ(base::UTF16ToUTF8(folder2->GetTitle()), "Folder2");
 }
+
+TEST_F(BraveBookmarkChangeProcessorTest, BookmarkAddedWithObjectIdFromSync) {
+  // A node added with sync meta info, e.g. by undoing a removal, must be
+  // found by its object id
+  change_processor()->Start();
+
+  RecordsList records;
+  records.push_back(SimpleBookmarkSyncRecord(
+      jslib::SyncRecord::Action::A_CREATE,
+      "1, 2, 3", "https://a.com/", "A.com - title", "1.1.1.1", ""));
+  change_processor()->ApplyChangesFromSyncModel(records);
+
+  BookmarkNode::MetaInfoMap meta_info;
+  meta_info["object_id"] = "4, 5, 6";
+  const auto* node_b = model()->AddURLWithCreationTimeAndMetaInfo(
+      model()->other_node(), 1, base::ASCIIToUTF16("B.com - title"),
+      GURL("https://b.com/"), base::Time::Now(), &meta_info);
+
+  records.clear();
+  records.push_back(SimpleBookmarkSyncRecord(
+      jslib::SyncRecord::Action::A_UPDATE,
+      "4, 5, 6", "https://b.com/", "B.com - title - modified", "1.1.1.2", ""));
+  change_processor()->ApplyChangesFromSyncModel(records);
+
+  EXPECT_EQ(base::UTF16ToUTF8(node_b->GetTitle()), "B.com - title - modified");
+  EXPECT_EQ(model()->other_node()->child_count(), 2);
+}
+
+TEST_F(BraveBookmarkChangeProcessorTest, InsertByOrderFromSync) {
+  // Records arriving out of order are inserted sorted by order, around a
+  // local bookmark without one
+  change_processor()->Start();
+  model()->AddURL(model()->other_node(), 0, base::ASCIIToUTF16("local"),
+                  GURL("https://local.com/"));
+
+  const std::vector<std::string> orders = {
+      "1.1.1.10", "1.1.1.2", "1.1.1.1.5", "1.1.1.30", "1.1.1.1"};
+  RecordsList records;
+  for (const auto& order : orders) {
+    records.push_back(SimpleBookmarkSyncRecord(
+        jslib::SyncRecord::Action::A_CREATE, "id " + order,
+        "https://a.com/" + order, order, order, ""));
+  }
+  change_processor()->ApplyChangesFromSyncModel(records);
+
+  const std::vector<std::string> expected = {
+      "local", "1.1.1.1", "1.1.1.1.5", "1.1.1.2", "1.1.1.10", "1.1.1.30"};
+  ASSERT_EQ(model()->other_node()->child_count(),
+            static_cast<int>(expected.size()));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(base::UTF16ToUTF8(
+                  model()->other_node()->GetChild(i)->GetTitle()),
+              expected[i]);
+  }
+}
+
+TEST_F(BraveBookmarkChangeProcessorTest, InsertByOrderAfterNonEmptyFolder) {
+  // A child that has children of its own doesn't stop the search for the
+  // insertion position
+  const auto* a = model()->AddURL(model()->other_node(), 0,
+                                  base::ASCIIToUTF16("a"),
+                                  GURL("https://a.com/"));
+  model()->SetNodeMetaInfo(a, "order", "1.1.1.1");
+  const auto* folder = model()->AddFolder(model()->other_node(), 1,
+                                          base::ASCIIToUTF16("folder"));
+  model()->SetNodeMetaInfo(folder, "order", "1.1.1.2");
+  const auto* child = model()->AddURL(folder, 0, base::ASCIIToUTF16("child"),
+                                      GURL("https://child.com/"));
+  model()->SetNodeMetaInfo(child, "order", "1.1.1.2.1");
+  const auto* c = model()->AddURL(model()->other_node(), 2,
+                                  base::ASCIIToUTF16("c"),
+                                  GURL("https://c.com/"));
+  model()->SetNodeMetaInfo(c, "order", "1.1.1.3");
+  change_processor()->Start();
+
+  RecordsList records;
+  records.push_back(SimpleBookmarkSyncRecord(
+      jslib::SyncRecord::Action::A_CREATE, "1, 2, 3", "https://d.com/",
+      "d", "1.1.1.4", ""));
+  records.push_back(SimpleBookmarkSyncRecord(
+      jslib::SyncRecord::Action::A_CREATE, "4, 5, 6", "https://b.com/",
+      "b", "1.1.1.1.5", ""));
+  change_processor()->ApplyChangesFromSyncModel(records);
+
+  const std::vector<std::string> expected = {"a", "b", "folder", "c", "d"};
+  ASSERT_EQ(model()->other_node()->child_count(),
+            static_cast<int>(expected.size()));
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(base::UTF16ToUTF8(
+                  model()->other_node()->GetChild(i)->GetTitle()),
+              expected[i]);
+  }
+}
+
+TEST_F(BraveBookmarkChangeProcessorTest, ObjectIdIndexFollowsModelChanges) {
+  change_processor()->Start();
+
+  RecordsList records;
+  records.push_back(SimpleBookmarkSyncRecord(
+      jslib::SyncRecord::Action::A_CREATE,
+      "1, 2, 3", "https://a.com/", "A.com - title", "1.1.1.1", ""));
+  change_processor()->ApplyChangesFromSyncModel(records);
+  ASSERT_EQ(model()->other_node()->child_count(), 1);
+  const auto* node = model()->other_node()->GetChild(0);
+
+  // while observing, the index follows the model between batches
+  model()->SetNodeMetaInfo(node, "object_id", "4, 5, 6");
+  records.clear();
+  records.push_back(SimpleBookmarkSyncRecord(
+      jslib::SyncRecord::Action::A_UPDATE,
+      "4, 5, 6", "https://a.com/", "A.com - title 2", "1.1.1.1", ""));
+  change_processor()->ApplyChangesFromSyncModel(records);
+  EXPECT_EQ(base::UTF16ToUTF8(node->GetTitle()), "A.com - title 2");
+
+  // changes made while stopped are picked up by the next batch
+  change_processor()->Stop();
+  model()->SetNodeMetaInfo(node, "object_id", "7, 8, 9");
+  records.clear();
+  records.push_back(SimpleBookmarkSyncRecord(
+      jslib::SyncRecord::Action::A_UPDATE,
+      "7, 8, 9", "https://a.com/", "A.com - title 3", "1.1.1.1", ""));
+  change_processor()->ApplyChangesFromSyncModel(records);
+  EXPECT_EQ(base::UTF16ToUTF8(node->GetTitle()), "A.com - title 3");
+  EXPECT_EQ(model()->other_node()->child_count(), 1);
+}
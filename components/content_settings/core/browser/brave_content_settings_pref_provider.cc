@@ -4,12 +4,27 @@
 
 #include "brave/components/content_settings/core/browser/brave_content_settings_pref_provider.h"
 
+#include "base/atomicops.h"
 #include "base/bind.h"
 #include "components/content_settings/core/browser/content_settings_pref.h"
 #include "components/content_settings/core/browser/website_settings_registry.h"
 
+namespace {
+
+base::subtle::Atomic32 g_brave_shields_settings_version = 0;
+
+void IncrementBraveShieldsSettingsVersion() {
+  base::subtle::Barrier_AtomicIncrement(&g_brave_shields_settings_version, 1);
+}
+
+}  // namespace
+
 namespace content_settings {
 
+uint32_t GetBraveShieldsSettingsVersion() {
+  return base::subtle::Acquire_Load(&g_brave_shields_settings_version);
+}
+
 BravePrefProvider::BravePrefProvider(PrefService* prefs,
                                      bool incognito,
                                      bool store_last_modified)
@@ -27,7 +42,8 @@ BravePrefProvider::BravePrefProvider(PrefService* prefs,
               info->type(), prefs_, &brave_pref_change_registrar_,
               info->pref_name(),
               is_incognito_,
-              base::Bind(&PrefProvider::Notify, base::Unretained(this)))));
+              base::Bind(&BravePrefProvider::OnShieldsSettingChanged,
+                         base::Unretained(this)))));
       return;
     }
   }
@@ -36,6 +52,18 @@ BravePrefProvider::BravePrefProvider(PrefService* prefs,
 void BravePrefProvider::ShutdownOnUIThread() {
   brave_pref_change_registrar_.RemoveAll();
   PrefProvider::ShutdownOnUIThread();
+  // The profile is going away; nothing cached for it may be reused.
+  IncrementBraveShieldsSettingsVersion();
+}
+
+void BravePrefProvider::OnShieldsSettingChanged(
+    const ContentSettingsPattern& primary_pattern,
+    const ContentSettingsPattern& secondary_pattern,
+    ContentSettingsType content_type,
+    const std::string& resource_identifier) {
+  IncrementBraveShieldsSettingsVersion();
+  Notify(primary_pattern, secondary_pattern, content_type,
+         resource_identifier);
 }
 
 bool BravePrefProvider::SetWebsiteSetting(
@@ -5,11 +5,20 @@
 #ifndef BRAVE_COMPONENTS_CONTENT_SETTINGS_CORE_BROWSER_BRAVE_CONTENT_SETTINGS_PREF_PROVIDER_H_
 #define BRAVE_COMPONENTS_CONTENT_SETTINGS_CORE_BROWSER_BRAVE_CONTENT_SETTINGS_PREF_PROVIDER_H_
 
+#include <stdint.h>
+
+#include <string>
+
 #include "components/content_settings/core/browser/content_settings_pref_provider.h"
 #include "components/prefs/pref_change_registrar.h"
 
 namespace content_settings {
 
+// Returns a number that changes whenever a shields setting changes in any
+// profile, so shields settings cached on other threads can be invalidated.
+// Safe to call from any thread.
+uint32_t GetBraveShieldsSettingsVersion();
+
 // With this subclass, shields configuration is persisted across sessions.
 // Its content type is |CONTENT_SETTINGS_TYPE_PLUGIN| and its storage option is
 // ephemeral because chromium want that flash configuration shouldn't be
@@ -33,6 +42,11 @@ class BravePrefProvider : public PrefProvider {
       const ResourceIdentifier& resource_identifier,
       base::Value* value) override;
 
+  void OnShieldsSettingChanged(const ContentSettingsPattern& primary_pattern,
+                               const ContentSettingsPattern& secondary_pattern,
+                               ContentSettingsType content_type,
+                               const std::string& resource_identifier);
+
   // PrefProvider::pref_change_registrar_ alreay has plugin type.
   PrefChangeRegistrar brave_pref_change_registrar_;
 
@@ -4,11 +4,13 @@
 
 #include "brave/renderer/brave_content_settings_observer.h"
 
+#include <vector>
+
+#include "base/no_destructor.h"
 #include "base/strings/utf_string_conversions.h"
 #include "brave/common/render_messages.h"
 #include "brave/content/common/frame_messages.h"
 #include "components/content_settings/core/common/content_settings_pattern.h"
-#include "components/content_settings/core/common/content_settings_utils.h"
 #include "content/public/renderer/render_frame.h"
 #include "services/service_manager/public/cpp/interface_provider.h"
 #include "third_party/blink/public/platform/web_url.h"
@@ -17,6 +19,22 @@
 #include "third_party/blink/public/web/web_local_frame.h"
 #include "url/url_constants.h"
 
+namespace {
+
+// Content settings patterns only match the scheme, host and port of http
+// and https URLs, so their decisions can be cached by origin.
+std::string GetCacheKey(const GURL& url) {
+  return url.SchemeIsHTTPOrHTTPS() ? url.GetOrigin().spec() : url.spec();
+}
+
+const ContentSettingsPattern& GetFirstPartyPattern() {
+  static const base::NoDestructor<ContentSettingsPattern> pattern(
+      ContentSettingsPattern::FromString("https://firstParty/*"));
+  return *pattern;
+}
+
+}  // namespace
+
 BraveContentSettingsObserver::BraveContentSettingsObserver(
     content::RenderFrame* render_frame,
     bool should_whitelist,
@@ -48,6 +66,9 @@ void BraveContentSettingsObserver::DidCommitProvisionalLoad(
   if (!is_same_document_navigation) {
     temporarily_allowed_scripts_ =
       std::move(preloaded_temporarily_allowed_scripts_);
+    cached_shields_down_.clear();
+    cached_fingerprinting_settings_.clear();
+    cached_autoplay_setting_.reset();
   }
 
   ContentSettingsObserver::DidCommitProvisionalLoad(
@@ -140,19 +161,16 @@ ContentSetting BraveContentSettingsObserver::GetFPContentSettingFromRules(
     const ContentSettingsForOneType& rules,
     const blink::WebFrame* frame,
     const GURL& secondary_url) {
-
-  if (rules.size() == 0)
-    return CONTENT_SETTING_DEFAULT;
-
   const GURL& primary_url = GetOriginOrURL(frame);
+  // "https://firstParty/*" stands for the domain of the primary URL.
+  const ContentSettingsPattern first_party_pattern =
+      ContentSettingsPattern::FromString(
+          "[*.]" + primary_url.HostNoBrackets());
 
   for (const auto& rule : rules) {
-    ContentSettingsPattern secondary_pattern = rule.secondary_pattern;
-    if (rule.secondary_pattern ==
-        ContentSettingsPattern::FromString("https://firstParty/*")) {
-      secondary_pattern = ContentSettingsPattern::FromString(
-          "[*.]" + GetOriginOrURL(frame).HostNoBrackets());
-    }
+    const ContentSettingsPattern& secondary_pattern =
+        rule.secondary_pattern == GetFirstPartyPattern() ?
+            first_party_pattern : rule.secondary_pattern;
 
     if (rule.primary_pattern.Matches(primary_url) &&
         (secondary_pattern == ContentSettingsPattern::Wildcard() ||
@@ -161,6 +179,10 @@ ContentSetting BraveContentSettingsObserver::GetFPContentSettingFromRules(
     }
   }
 
+  // first party resources which don't match any existing rules are allowed
+  if (first_party_pattern.Matches(secondary_url))
+    return CONTENT_SETTING_ALLOW;
+
   // for cases which are third party resources and doesn't match any existing
   // rules, block them by default
   return CONTENT_SETTING_BLOCK;
@@ -169,6 +191,11 @@ ContentSetting BraveContentSettingsObserver::GetFPContentSettingFromRules(
 bool BraveContentSettingsObserver::IsBraveShieldsDown(
     const blink::WebFrame* frame,
     const GURL& secondary_url) {
+  const std::string key = GetCacheKey(secondary_url);
+  auto cached = cached_shields_down_.find(key);
+  if (cached != cached_shields_down_.end())
+    return cached->second;
+
   ContentSetting setting = CONTENT_SETTING_DEFAULT;
   const GURL& primary_url = GetOriginOrURL(frame);
 
@@ -182,7 +209,9 @@ bool BraveContentSettingsObserver::IsBraveShieldsDown(
     }
   }
 
-  return setting == CONTENT_SETTING_BLOCK;
+  const bool shields_down = setting == CONTENT_SETTING_BLOCK;
+  cached_shields_down_[key] = shields_down;
+  return shields_down;
 }
 
 bool BraveContentSettingsObserver::AllowFingerprinting(
@@ -195,19 +224,20 @@ bool BraveContentSettingsObserver::AllowFingerprinting(
   if (IsBraveShieldsDown(frame, secondary_url)) {
     return true;
   }
-  ContentSettingsForOneType rules;
-  if (content_setting_rules_) {
-      rules = content_setting_rules_->fingerprinting_rules;
+
+  const std::string key = GetCacheKey(secondary_url);
+  auto cached = cached_fingerprinting_settings_.find(key);
+  ContentSetting setting;
+  if (cached != cached_fingerprinting_settings_.end()) {
+    setting = cached->second;
+  } else {
+    static const base::NoDestructor<ContentSettingsForOneType> no_rules;
+    setting = GetFPContentSettingFromRules(
+        content_setting_rules_ ?
+            content_setting_rules_->fingerprinting_rules : *no_rules,
+        frame, secondary_url);
+    cached_fingerprinting_settings_[key] = setting;
   }
-  ContentSettingPatternSource default_rule =
-      ContentSettingPatternSource(ContentSettingsPattern::Wildcard(),
-                                  ContentSettingsPattern::FromString("https://firstParty/*"),
-                                  base::Value::FromUniquePtrValue(content_settings::ContentSettingToValue(CONTENT_SETTING_ALLOW)),
-                                  std::string(),
-                                  false);
-  rules.push_back(default_rule);
-  ContentSetting setting = GetFPContentSettingFromRules(rules, frame, secondary_url);
-  rules.pop_back();
   bool allow = setting != CONTENT_SETTING_BLOCK;
   allow = allow || IsWhitelistedForContentSettings();
 
@@ -218,6 +248,73 @@ bool BraveContentSettingsObserver::AllowFingerprinting(
   return allow;
 }
 
+ContentSetting BraveContentSettingsObserver::GetAutoplayContentSetting(
+    blink::WebLocalFrame* frame) {
+  if (cached_autoplay_setting_)
+    return *cached_autoplay_setting_;
+
+  // respect user's site blocklist, if any
+  const GURL& primary_url = GetOriginOrURL(frame);
+  const GURL& secondary_url =
+      url::Origin(frame->GetDocument().GetSecurityOrigin()).GetURL();
+  if (content_setting_rules_) {
+    for (const auto& rule : content_setting_rules_->autoplay_rules) {
+      if (rule.primary_pattern == ContentSettingsPattern::Wildcard())
+          continue;
+      if (rule.primary_pattern.Matches(primary_url) &&
+          (rule.secondary_pattern == ContentSettingsPattern::Wildcard() ||
+           rule.secondary_pattern.Matches(secondary_url))) {
+        if (rule.GetContentSetting() == CONTENT_SETTING_BLOCK) {
+          cached_autoplay_setting_ = CONTENT_SETTING_BLOCK;
+          return CONTENT_SETTING_BLOCK;
+        }
+      }
+    }
+  }
+
+  // in the absence of an explicit block rule, whitelist the following sites
+  static const base::NoDestructor<std::vector<ContentSettingsPattern>>
+      whitelist_patterns([] {
+    const char* patterns[] = {
+        "[*.]example.com",
+        "[*.]youtube.com",
+        "[*.]khanacademy.org",
+        "[*.]twitch.tv",
+        "[*.]vimeo.com",
+        "[*.]udemy.com",
+        "[*.]duolingo.com",
+        "[*.]giphy.com",
+        "[*.]imgur.com",
+        "[*.]netflix.com",
+        "[*.]hulu.com",
+        "[*.]primevideo.com",
+        "[*.]dailymotion.com",
+        "[*.]tv.com",
+        "[*.]viewster.com",
+        "[*.]metacafe.com",
+        "[*.]d.tube",
+        "[*.]spotify.com",
+        "[*.]lynda.com",
+        "[*.]soundcloud.com",
+        "[*.]pandora.com",
+        "[*.]periscope.tv",
+        "[*.]pscp.tv",
+    };
+    std::vector<ContentSettingsPattern> compiled;
+    for (const char* pattern : patterns)
+      compiled.push_back(ContentSettingsPattern::FromString(pattern));
+    return compiled;
+  }());
+  cached_autoplay_setting_ = CONTENT_SETTING_ASK;
+  for (const auto& pattern : *whitelist_patterns) {
+    if (pattern.Matches(primary_url)) {
+      cached_autoplay_setting_ = CONTENT_SETTING_ALLOW;
+      break;
+    }
+  }
+  return *cached_autoplay_setting_;
+}
+
 bool BraveContentSettingsObserver::AllowAutoplay(bool default_value) {
   blink::WebLocalFrame* frame = render_frame()->GetWebFrame();
   auto origin = frame->GetDocument().GetSecurityOrigin();
@@ -229,50 +326,11 @@ bool BraveContentSettingsObserver::AllowAutoplay(bool default_value) {
   if (allow)
     return true;
 
-  // respect user's site blocklist, if any
-  const GURL& primary_url = GetOriginOrURL(frame);
-  const GURL& secondary_url = url::Origin(frame->GetDocument().GetSecurityOrigin()).GetURL();
-  for (const auto& rule : content_setting_rules_->autoplay_rules) {
-    if (rule.primary_pattern == ContentSettingsPattern::Wildcard())
-        continue;
-    if (rule.primary_pattern.Matches(primary_url) &&
-        (rule.secondary_pattern == ContentSettingsPattern::Wildcard() ||
-         rule.secondary_pattern.Matches(secondary_url))) {
-      if (rule.GetContentSetting() == CONTENT_SETTING_BLOCK)
-        return false;
-    }
-  }
-
-  // in the absence of an explicit block rule, whitelist the following sites
-  std::string kWhitelistPatterns[] = {
-      "[*.]example.com",
-      "[*.]youtube.com",
-      "[*.]khanacademy.org",
-      "[*.]twitch.tv",
-      "[*.]vimeo.com",
-      "[*.]udemy.com",
-      "[*.]duolingo.com",
-      "[*.]giphy.com",
-      "[*.]imgur.com",
-      "[*.]netflix.com",
-      "[*.]hulu.com",
-      "[*.]primevideo.com",
-      "[*.]dailymotion.com",
-      "[*.]tv.com",
-      "[*.]viewster.com",
-      "[*.]metacafe.com",
-      "[*.]d.tube",
-      "[*.]spotify.com",
-      "[*.]lynda.com",
-      "[*.]soundcloud.com",
-      "[*.]pandora.com",
-      "[*.]periscope.tv",
-      "[*.]pscp.tv",
-  };
-  for (const auto& pattern : kWhitelistPatterns) {
-    if (ContentSettingsPattern::FromString(pattern).Matches(primary_url))
-      return true;
-  }
+  const ContentSetting setting = GetAutoplayContentSetting(frame);
+  if (setting == CONTENT_SETTING_BLOCK)
+    return false;
+  if (setting == CONTENT_SETTING_ALLOW)
+    return true;
 
   blink::mojom::blink::PermissionServicePtr permission_service;
 
@@ -5,6 +5,10 @@
 #ifndef BRAVE_RENDERER_CONTENT_SETTINGS_OBSERVER_H_
 #define BRAVE_RENDERER_CONTENT_SETTINGS_OBSERVER_H_
 
+#include <string>
+
+#include "base/containers/flat_map.h"
+#include "base/optional.h"
 #include "base/strings/string16.h"
 #include "chrome/renderer/content_settings_observer.h"
 #include "components/content_settings/core/common/content_settings.h"
@@ -59,6 +63,8 @@ class BraveContentSettingsObserver
 
   bool IsScriptTemporilyAllowed(const GURL& script_url);
 
+  ContentSetting GetAutoplayContentSetting(blink::WebLocalFrame* frame);
+
   // Origins of scripts which are temporary allowed for this frame in the
   // current load
   base::flat_set<std::string> temporarily_allowed_scripts_;
@@ -69,6 +75,15 @@ class BraveContentSettingsObserver
   // temporary allowed script origins we preloaded for the next load
   base::flat_set<std::string> preloaded_temporarily_allowed_scripts_;
 
+  // Decisions for the current load, by secondary URL (see GetCacheKey()).
+  // Like ContentSettingsObserver's cached script permissions, rule changes
+  // take effect on the next load, and the primary URL, the top frame's
+  // origin, doesn't change within a load.
+  base::flat_map<std::string, bool> cached_shields_down_;
+  base::flat_map<std::string, ContentSetting> cached_fingerprinting_settings_;
+  // ALLOW for whitelisted sites, BLOCK for blocked ones, ASK otherwise.
+  base::Optional<ContentSetting> cached_autoplay_setting_;
+
   DISALLOW_COPY_AND_ASSIGN(BraveContentSettingsObserver);
 };
 
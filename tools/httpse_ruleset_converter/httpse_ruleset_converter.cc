@@ -0,0 +1,83 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Converts an unzipped httpse.leveldb into the flat, memory mappable
+// httpse.rulesets file read by HTTPSEFlatRuleSets.
+//
+// Usage: httpse_ruleset_converter <httpse.leveldb dir> <httpse.rulesets>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "brave/components/brave_shields/browser/https_everywhere_flat_rulesets.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+
+int main(int argc, char* argv[]) {
+  base::AtExitManager at_exit;
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine::StringVector& args =
+      base::CommandLine::ForCurrentProcess()->GetArgs();
+  if (args.size() != 2) {
+    std::cerr << "Usage: httpse_ruleset_converter "
+              << "<httpse.leveldb dir> <httpse.rulesets>" << std::endl;
+    return 1;
+  }
+  const base::FilePath input_path(args[0]);
+  const base::FilePath output_path(args[1]);
+
+  leveldb::DB* db = nullptr;
+  leveldb::Options options;
+  options.create_if_missing = false;
+  leveldb::Status status =
+      leveldb::DB::Open(options, input_path.AsUTF8Unsafe(), &db);
+  if (!status.ok()) {
+    std::cerr << "Cannot open " << input_path.AsUTF8Unsafe() << ": "
+              << status.ToString() << std::endl;
+    return 1;
+  }
+  std::unique_ptr<leveldb::DB> db_owner(db);
+
+  std::vector<std::pair<std::string, std::string>> entries;
+  std::unique_ptr<leveldb::Iterator> it(
+      db->NewIterator(leveldb::ReadOptions()));
+  for (it->SeekToFirst(); it->Valid(); it->Next()) {
+    entries.push_back(
+        std::make_pair(it->key().ToString(), it->value().ToString()));
+  }
+  if (!it->status().ok()) {
+    std::cerr << "Cannot read " << input_path.AsUTF8Unsafe() << ": "
+              << it->status().ToString() << std::endl;
+    return 1;
+  }
+
+  const size_t entry_count = entries.size();
+  std::string output;
+  if (!brave_shields::HTTPSEFlatRuleSets::Serialize(std::move(entries),
+                                                    &output)) {
+    std::cerr << "Cannot serialize rulesets" << std::endl;
+    return 1;
+  }
+  if (base::WriteFile(output_path, output.data(), output.size()) !=
+      static_cast<int>(output.size())) {
+    std::cerr << "Cannot write " << output_path.AsUTF8Unsafe() << std::endl;
+    return 1;
+  }
+
+  // Make sure the written file is accepted by the browser.
+  if (!brave_shields::HTTPSEFlatRuleSets::Load(output_path)) {
+    std::cerr << "Written file failed validation" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Wrote " << entry_count << " rulesets to "
+            << output_path.AsUTF8Unsafe() << std::endl;
+  return 0;
+}